@@ -29,6 +29,26 @@
 extern "C" {
 #endif
 
+/**
+ * Playout statistics of the codec decoder. Frame counters are cleared each
+ * time a new decoding operation is started.
+ *
+ * For live streams, decoding starts once four frames (80ms) have been queued.
+ * The target depth grows, up to twelve frames, when frames arrive late and
+ * shrinks back after a period of regular arrivals.
+ */
+typedef struct
+{
+    uint32_t played;      ///< Frames decoded and sent to the audio output.
+    uint32_t concealed;   ///< Frames synthesised by packet loss concealment.
+    uint32_t late;        ///< Frames arrived after their playout slot.
+    uint32_t early;       ///< Frames discarded to bound the playout latency.
+    uint32_t dropped;     ///< Frames rejected because the queue was full.
+    uint8_t  depth;       ///< Current playout buffer depth, in frames.
+    uint8_t  target;      ///< Current playout target depth, in frames.
+}
+codecStats_t;
+
 /**
  * Initialise audio codec manager, allocating data buffers.
  *
@@ -45,8 +65,10 @@ void codec_terminate();
 
 /**
  * Start encoding of audio data from a given audio source.
- * Only an encoding or decoding operation at a time is possible: in case there
- * is already an operation in progress, this function returns false.
+ * Only one encoding or decoding operation at a time is possible, two decoding
+ * operations on different paths when the speaker output is mixed: an operation
+ * in progress is stopped only if its path has a lower priority or is no longer
+ * open, otherwise this function returns false.
  *
  * @param path: audio path for encoding source.
  * @return true on success, false on failure.
@@ -56,13 +78,18 @@ bool codec_startEncode(const pathId path);
 /**
  * Start dencoding of audio data sending the uncompressed samples to a given
  * audio destination.
- * Only an encoding or decoding operation at a time is possible: in case there
- * is already an operation in progress, this function returns false.
+ * Only one encoding or decoding operation at a time is possible, two decoding
+ * operations on different paths when the speaker output is mixed: an operation
+ * in progress is stopped only if its path has a lower priority or is no longer
+ * open, otherwise this function returns false.
  *
  * @param path: audio path for decoded audio.
+ * @param live: true if the frames come from a live stream with irregular
+ * arrival times, enabling the discard of the excess frames and the concealment
+ * of the missing ones.
  * @return true on success, false on failure.
  */
-bool codec_startDecode(const pathId path);
+bool codec_startDecode(const pathId path, const bool live);
 
 /**
  * Stop an ongoing encoding or decoding operation.
@@ -73,11 +100,23 @@ bool codec_startDecode(const pathId path);
 void codec_stop(const pathId path);
 
 /**
- * Get current oprational status of the codec thread.
+ * Request the termination of an ongoing decoding operation once all the queued
+ * frames have been played. This function does not block and has to be called
+ * periodically until it returns false.
+ *
+ * @param path: audio path on which the decoding operation was started.
+ * @return true if the decoding operation is still running.
+ */
+bool codec_drain(const pathId path);
+
+/**
+ * Get current oprational status of the codec thread of a given path.
  *
+ * @param path: audio path on which the encoding or decoding operation was
+ * started.
  * @return true if the codec thread is active.
  */
-bool codec_running();
+bool codec_running(const pathId path);
 
 /**
  * Get a compressed audio frame from the internal queue. Each frame is composed
@@ -95,14 +134,50 @@ int codec_popFrame(uint8_t *frame, const bool blocking);
  * Push a a compressed audio frame to the internal queue for decoding.
  * Each frame is composed of 8 bytes.
  *
+ * @param path: audio path on which the decoding operation was started.
  * @param frame: frame to be pushed to the queue.
  * @param blocking: if true the execution flow will be blocked whenever the
  * internal buffer is full and resumed as soon as space for an encoded frame is
  * available.
  * @return zero on success, -EAGAIN if the queue is full and the function is
- * nonblocking or -EPERM if there is no decoding operation ongoing.
+ * nonblocking or -EPERM if there is no decoding operation ongoing on the given
+ * path.
+ */
+int codec_pushFrame(const pathId path, const uint8_t *frame,
+                    const bool blocking);
+
+/**
+ * Copy to a buffer the audio decoded from a range of frames, with the same
+ * output processing of the decoding thread. This allows to keep the decoded
+ * audio of a decoding operation without having to decode its frames again.
+ * Frames are numbered in decoding order from the start of the decoding
+ * operation and each one produces 160 samples. Only one range at a time can be
+ * captured, a new call replaces the previous one.
+ * The capture is complete once codec_capturedFrames() returns the number of
+ * frames of the range.
+ *
+ * @param path: audio path on which the decoding operation was started.
+ * @param buf: destination buffer, with space for 160 samples per frame, or
+ * NULL to cancel the capture.
+ * @param first: number of the first frame to be captured.
+ * @param numFrames: number of frames to be captured.
+ */
+void codec_captureFrames(const pathId path, stream_sample_t *buf,
+                         const uint32_t first, const uint32_t numFrames);
+
+/**
+ * Get the number of frames copied since the last call to codec_captureFrames().
+ *
+ * @return number of captured frames.
+ */
+uint32_t codec_capturedFrames();
+
+/**
+ * Get the playout statistics of the current or last live decoding operation.
+ *
+ * @param stats: pointer to a destination structure for the statistics.
  */
-int codec_pushFrame(const uint8_t *frame, const bool blocking);
+void codec_getStats(codecStats_t *stats);
 
 #ifdef __cplusplus
 }
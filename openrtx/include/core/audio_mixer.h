@@ -0,0 +1,79 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <interfaces/audio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Software mixer for output audio streams.
+ *
+ * The mixer is an audio driver sitting between the output streams and an
+ * audio device: each stream started through the mixer becomes one of its
+ * inputs and all the inputs are summed together in a single circular buffer
+ * transferred to the device. A dedicated thread performs the mixing, pacing
+ * the input streams as the device would do.
+ *
+ * Each input has its own gain, while inputs having a priority lower than the
+ * highest one among the active inputs are attenuated ("ducked"). All the
+ * inputs must have the same sample rate.
+ */
+
+/**
+ * Maximum number of concurrent mixer inputs.
+ */
+#define MIXER_MAX_INPUTS 3
+
+/**
+ * Unity gain value for the mixer inputs.
+ */
+#define MIXER_GAIN_UNITY 128
+
+/**
+ * Configuration of a mixer input, to be passed as configuration parameter to
+ * the start() function of the mixer driver.
+ */
+struct mixerCfg
+{
+    const struct audioDevice *device;    ///< Audio device driven by the mixer.
+    uint8_t                   priority;  ///< Priority of the input stream.
+};
+
+/**
+ * Set the gain of a mixer input.
+ *
+ * @param ctx: context of the audio stream feeding the mixer input.
+ * @param gain: new gain, MIXER_GAIN_UNITY corresponds to 0dB.
+ */
+void mixer_setGain(struct streamCtx *ctx, const uint8_t gain);
+
+extern const struct audioDriver mixer_audio_driver;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_MIXER_H */
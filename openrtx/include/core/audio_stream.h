@@ -47,6 +47,17 @@ typedef struct
 }
 dataBlock_t;
 
+/**
+ * Statistics of an audio stream, collected by the buffer lending functions.
+ */
+typedef struct
+{
+    uint32_t blocks;     ///< Number of blocks lent to the stream user.
+    uint32_t overruns;   ///< Input blocks overwritten while still lent.
+    uint32_t underruns;  ///< Output blocks released after their playback begun.
+}
+streamStats_t;
+
 /**
  * Start an audio stream, either in input or output mode as specified by the
  * corresponding parameter.
@@ -54,6 +65,10 @@ dataBlock_t;
  * WARNING: for output streams the caller must ensure that buffer content is not
  * modified while the stream is being reproduced.
  *
+ * When CONFIG_AUDIO_NATIVE_RATE is defined, streams at a different sample rate
+ * are converted to and from the native one. Linear input streams at a sample
+ * rate other than the native one are not supported and -EINVAL is returned.
+ *
  * @param path: audio path for the stream.
  * @param buf: buffer containing the audio samples.
  * @param length: length of the buffer, in elements.
@@ -81,6 +96,15 @@ void audioStream_stop(const streamId id);
  */
 void audioStream_terminate(const streamId id);
 
+/**
+ * Check if an audio stream is still active. Streams running in linear mode
+ * stop automatically once the end of the buffer is reached.
+ *
+ * @param id: identifier of the stream.
+ * @return true if the stream is running.
+ */
+bool audioStream_running(const streamId id);
+
 /**
  * Get a chunk of data from an already opened input stream, blocking function.
  * If buffer management is configured to BUF_LINEAR this function also starts a
@@ -93,6 +117,60 @@ void audioStream_terminate(const streamId id);
  */
 dataBlock_t inputStream_getData(streamId id);
 
+/**
+ * Acquire a block of samples from an input stream, blocking function.
+ * If no new block has been completed since the previous acquisition, execution
+ * is blocked until the next one is ready. The block is lent to the caller,
+ * which can process it in place, until its release: only one block per stream
+ * can be lent at a time.
+ *
+ * @param id: stream identifier.
+ * @return the acquired block or an empty block in case of errors or if another
+ * block is still lent.
+ */
+dataBlock_t inputStream_acquire(const streamId id);
+
+/**
+ * Release a block of samples previously acquired from an input stream. If the
+ * block has been overwritten by new samples while lent, an overrun is counted.
+ *
+ * @param id: stream identifier.
+ * @param block: the block to be released.
+ */
+void inputStream_release(const streamId id, const dataBlock_t block);
+
+/**
+ * Acquire the idle block of an output stream. The block is lent to the caller
+ * for being filled with new samples until its release: only one block per
+ * stream can be lent at a time.
+ *
+ * @param id: stream identifier.
+ * @return the acquired block or an empty block in case of errors or if another
+ * block is still lent.
+ */
+dataBlock_t outputStream_acquire(const streamId id);
+
+/**
+ * Release a block of samples previously acquired from an output stream,
+ * queueing it for playback, blocking function. Execution is blocked until the
+ * playback of the block begins. If the playback has already begun before the
+ * release, an underrun is counted.
+ *
+ * @param id: stream identifier.
+ * @param block: the block to be released.
+ * @return true on success, false if the stream is not running or the block is
+ * not the one lent.
+ */
+bool outputStream_release(const streamId id, const dataBlock_t block);
+
+/**
+ * Get the statistics of an audio stream.
+ *
+ * @param id: stream identifier.
+ * @return the stream statistics, all zero if the stream is not valid.
+ */
+streamStats_t audioStream_getStats(const streamId id);
+
 /**
  * Get a pointer to the section of the sample buffer not currently being read
  * by the DMA peripheral. The function is to be used primarily when the output
@@ -122,6 +200,16 @@ stream_sample_t *outputStream_getIdleBuffer(const streamId id);
  */
 bool outputStream_sync(const streamId id, const bool bufChanged);
 
+/**
+ * Set the gain of an output stream. The gain is applied only to the output
+ * streams going through the audio mixer, that is the ones directed to the
+ * speaker when the mixer is enabled, and ignored otherwise.
+ *
+ * @param id: stream identifier.
+ * @param gain: stream gain, 128 corresponds to 0dB.
+ */
+void outputStream_setGain(const streamId id, const uint8_t gain);
+
 #ifdef __cplusplus
 }
 #endif
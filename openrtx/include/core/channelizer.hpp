@@ -0,0 +1,208 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef CHANNELIZER_H
+#define CHANNELIZER_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <complex>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+/**
+ * Polyphase filter bank channelizer, splitting a complex wideband signal in M
+ * equally spaced channels, M being a power of two. Channel k is centered at
+ * k * fs / M, channels from M/2 onwards corresponding to negative frequencies.
+ *
+ * The channelizer is oversampled by a factor two: a new set of outputs, one for
+ * each channel, is computed every M/2 input samples and each channel is
+ * sampled at 2 * fs / M. This keeps the channel transition bands free from
+ * aliasing.
+ *
+ * Each output set is computed by weighting the last M * P input samples with a
+ * lowpass prototype filter, folding the result in M bins and computing their
+ * DFT. As the DFT phase is referenced to the absolute input sample index, this
+ * is the same as mixing each channel down to baseband before filtering and
+ * decimating it.
+ */
+class Channelizer
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param channels: number of channels, must be a power of two.
+     * @param taps: number of prototype filter taps for each channel.
+     */
+    Channelizer(const size_t channels, const size_t taps = 12) :
+        M(channels), L(channels * taps), proto(L), hist(2 * L), bins(M),
+        twiddles(M / 2)
+    {
+        // Windowed-sinc prototype filter, cut at the channel edges
+        const double fc  = 0.5 / static_cast< double >(M);
+        const double mid = (static_cast< double >(L) - 1.0) / 2.0;
+        for(size_t i = 0; i < L; i++)
+        {
+            double x = static_cast< double >(i) - mid;
+            double h = 2.0 * fc;
+            if(x != 0.0)
+                h = std::sin(2.0 * M_PI * fc * x) / (M_PI * x);
+
+            double w = 0.42 - 0.5  * std::cos((2.0 * M_PI * i) / (L - 1))
+                            + 0.08 * std::cos((4.0 * M_PI * i) / (L - 1));
+            proto[i] = static_cast< float >(h * w);
+        }
+
+        for(size_t i = 0; i < M / 2; i++)
+            twiddles[i] = std::polar(1.0f, static_cast< float >(-2.0 * M_PI * i / M));
+
+        reset();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~Channelizer() { }
+
+    /**
+     * Push a new input sample into the channelizer.
+     *
+     * @param input: input sample.
+     * @param output: pointer to a buffer of at least M elements where the new
+     * output of each channel is stored, if available.
+     * @return true if a new set of channel outputs has been computed.
+     */
+    bool operator()(const std::complex< float > input,
+                    std::complex< float > *output)
+    {
+        pos = (pos == 0) ? (L - 1) : (pos - 1);
+        hist[pos]     = input;
+        hist[pos + L] = input;
+
+        const size_t index = phase;
+        phase = (phase + 1) % M;
+
+        count += 1;
+        if(count < (M / 2))
+            return false;
+
+        count = 0;
+
+        // Weight the input with the prototype filter and fold it in the bins
+        // corresponding to the absolute sample index modulo M.
+        const std::complex< float > *h = &hist[pos];
+        for(size_t r = 0; r < M; r++)
+            bins[r] = 0.0f;
+
+        size_t r = index;
+        for(size_t i = 0; i < L; i++)
+        {
+            bins[r] += h[i] * proto[i];
+            r = (r == 0) ? (M - 1) : (r - 1);
+        }
+
+        fft(output);
+        return true;
+    }
+
+    /**
+     * Reset the channelizer history, clearing the memory of past values.
+     */
+    void reset()
+    {
+        for(auto& h : hist)
+            h = 0.0f;
+
+        pos   = 0;
+        phase = 0;
+        count = 0;
+    }
+
+    /**
+     * Get the number of channels.
+     *
+     * @return number of channels.
+     */
+    size_t channels() const
+    {
+        return M;
+    }
+
+private:
+
+    /**
+     * Compute the DFT of the bins through a radix-2 FFT.
+     *
+     * @param out: pointer to the output buffer.
+     */
+    void fft(std::complex< float > *out)
+    {
+        // Bit-reversed copy
+        size_t bits = 0;
+        while((static_cast< size_t >(1) << bits) < M)
+            bits++;
+
+        for(size_t i = 0; i < M; i++)
+        {
+            size_t rev = 0;
+            for(size_t b = 0; b < bits; b++)
+            {
+                if(i & (static_cast< size_t >(1) << b))
+                    rev |= static_cast< size_t >(1) << (bits - 1 - b);
+            }
+
+            out[rev] = bins[i];
+        }
+
+        for(size_t len = 2; len <= M; len <<= 1)
+        {
+            const size_t half   = len / 2;
+            const size_t stride = M / len;
+
+            for(size_t i = 0; i < M; i += len)
+            {
+                for(size_t j = 0; j < half; j++)
+                {
+                    std::complex< float > t = out[i + j + half] * twiddles[j * stride];
+                    out[i + j + half] = out[i + j] - t;
+                    out[i + j]       += t;
+                }
+            }
+        }
+    }
+
+    const size_t                         M;         ///< Number of channels.
+    const size_t                         L;         ///< Prototype filter length.
+    std::vector< float >                 proto;     ///< Prototype filter taps.
+    std::vector< std::complex< float > > hist;      ///< Input history, doubled.
+    std::vector< std::complex< float > > bins;      ///< Folded filter output.
+    std::vector< std::complex< float > > twiddles;  ///< FFT twiddle factors.
+    size_t                               pos;       ///< Current position in history.
+    size_t                               phase;     ///< Absolute input index modulo M.
+    size_t                               count;     ///< Inputs since last output.
+};
+
+#endif /* CHANNELIZER_H */
@@ -28,11 +28,13 @@
 
 // Magic number to identify the binary file
 #define CPS_MAGIC 0x43585452
-// Codeplug version v0.1
+// Codeplug version v0.2
 #define CPS_VERSION_MAJOR  0
-#define CPS_VERSION_MINOR  1
+#define CPS_VERSION_MINOR  2
 #define CPS_VERSION_NUMBER (CPS_VERSION_MAJOR << 8) | CPS_VERSION_MINOR
 #define CPS_STR_SIZE 32
+// Null record identifier
+#define CPS_NO_RECORD 0xFFFF
 
 
 /******************************************************************************
@@ -248,10 +250,21 @@ __attribute__((packed)) bankHdr_t; // 18B + 2 * ch_count
 /**
  * The codeplug binary structure is composed by:
  * - A header struct
- * - A variable length array of all the contacts
- * - A variable length array of all the channels
+ * - A record allocation struct
+ * - A variable length array of contact records
+ * - A variable length array of channel records
  * - A variable length array of the offsets to reach each bank
  * - A binary dense structure of all the banks
+ * - A variable length array with the record IDs of the contacts
+ * - A variable length array with the record IDs of the channels
+ *
+ * Contacts and channels are stored in record slots identified by a stable ID,
+ * their position in the contact and channel lists is given by the two index
+ * arrays at the end of the codeplug. Channels refer to contacts, and banks to
+ * channels, by record ID: inserting an entry touches only its record and the
+ * index arrays, deleting one also drops the references to it.
+ * Codeplugs of version 0.1 had no record allocation struct and index arrays,
+ * contacts and channels being stored directly in list order.
  */
 typedef struct
 {
@@ -267,6 +280,19 @@ typedef struct
 }
 __attribute__((packed)) cps_header_t; // 88B
 
+/**
+ * Record allocation data, following the codeplug header. Free record slots are
+ * chained in a list through their first two bytes.
+ */
+typedef struct
+{
+    uint16_t ct_slots;             //< Number of allocated contact records
+    uint16_t ch_slots;             //< Number of allocated channel records
+    uint16_t ct_free;              //< First free contact record
+    uint16_t ch_free;              //< First free channel record
+}
+__attribute__((packed)) cps_records_t; // 8B
+
 /**
  * Create and return a viable channel for this radio.
  * Suitable for default VFO settings or the creation of a new channel.
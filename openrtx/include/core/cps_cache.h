@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef CPS_CACHE_H
+#define CPS_CACHE_H
+
+#include <stdint.h>
+#include <cps.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Cache of codeplug records.
+ *
+ * Menus listing channels, contacts and banks read one record for each visible
+ * row at every redraw which, on most targets, means one nonvolatile memory
+ * access per row per frame. The functions below keep a small set of recently
+ * read records, including the outcome of reads past the end of a table, in
+ * RAM and return them without accessing the codeplug again.
+ *
+ * The cache is not thread safe and is meant to be used from the UI thread.
+ * Any code modifying the codeplug has to call cpsCache_invalidate() after
+ * having done so.
+ */
+
+/**
+ * Number of cached records for each record type.
+ */
+#define CPS_CACHE_CHANNELS 16
+#define CPS_CACHE_CONTACTS 8
+#define CPS_CACHE_BANKS    8
+
+/**
+ * Read one channel entry, going to the codeplug only if the entry is not
+ * cached.
+ *
+ * @param channel: pointer to the channel_t data structure to be populated.
+ * @param pos: position, inside the channel table, from which read data.
+ * @return 0 on success, -1 on failure
+ */
+int cpsCache_readChannel(channel_t *channel, uint16_t pos);
+
+/**
+ * Read one contact, going to the codeplug only if the contact is not cached.
+ *
+ * @param contact: pointer to the contact_t data structure to be populated.
+ * @param pos: position, inside the contact table, from which read data.
+ * @return 0 on success, -1 on failure
+ */
+int cpsCache_readContact(contact_t *contact, uint16_t pos);
+
+/**
+ * Read one bank header, going to the codeplug only if the header is not
+ * cached.
+ *
+ * @param b_header: pointer to the struct to be populated with the bank header.
+ * @param pos: position, inside the bank table, from which read data.
+ * @return 0 on success, -1 on failure
+ */
+int cpsCache_readBankHeader(bankHdr_t *b_header, uint16_t pos);
+
+/**
+ * Drop all the cached records.
+ */
+void cpsCache_invalidate();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CPS_CACHE_H */
@@ -28,6 +28,26 @@
 extern "C" {
 #endif
 
+/**
+ * Table-driven CRC engine.
+ *
+ * Two CRC flavours are provided:
+ * - CRC-16/CCITT, polynomial 0x1021, initial value 0x0000, no reflection and
+ *   no final XOR (also known as CRC-16/XMODEM);
+ * - CRC-32, polynomial 0x04C11DB7, reflected, initial value and final XOR
+ *   0xFFFFFFFF (IEEE 802.3, the same as zlib).
+ *
+ * Both are computed using slice-by-4 lookup tables, slice-by-8 when the
+ * CONFIG_CRC_SLICE_BY_8 macro is defined. When CONFIG_CRC_HW is defined, large
+ * blocks of data are processed by the hardware CRC unit of the platform, if
+ * available (see peripherals/hwcrc.h).
+ *
+ * Besides the one-shot functions, each CRC has a streaming interface allowing
+ * to process data in chunks: the CRC state is created with the init function,
+ * updated with each chunk of data and converted to the final CRC value with
+ * the final function.
+ */
+
 /**
  * Compute the CCITT 16-bit CRC over a given block of data.
  *
@@ -37,6 +57,77 @@ extern "C" {
  */
 uint16_t crc_ccitt(const void *data, const size_t len);
 
+/**
+ * Initialise a streaming CCITT 16-bit CRC computation.
+ *
+ * @return initial CRC state.
+ */
+static inline uint16_t crc_ccitt_init()
+{
+    return 0x0000;
+}
+
+/**
+ * Update a streaming CCITT 16-bit CRC computation with a block of data.
+ *
+ * @param crc: current CRC state.
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return updated CRC state.
+ */
+uint16_t crc_ccitt_update(uint16_t crc, const void *data, const size_t len);
+
+/**
+ * Finalise a streaming CCITT 16-bit CRC computation.
+ *
+ * @param crc: current CRC state.
+ * @return CCITT CRC.
+ */
+static inline uint16_t crc_ccitt_final(const uint16_t crc)
+{
+    return crc;
+}
+
+/**
+ * Compute the IEEE 802.3 32-bit CRC over a given block of data.
+ *
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return 32-bit CRC.
+ */
+uint32_t crc_32(const void *data, const size_t len);
+
+/**
+ * Initialise a streaming IEEE 802.3 32-bit CRC computation.
+ *
+ * @return initial CRC state.
+ */
+static inline uint32_t crc_32_init()
+{
+    return 0xFFFFFFFF;
+}
+
+/**
+ * Update a streaming IEEE 802.3 32-bit CRC computation with a block of data.
+ *
+ * @param crc: current CRC state.
+ * @param data: input data.
+ * @param len: data length, in bytes.
+ * @return updated CRC state.
+ */
+uint32_t crc_32_update(uint32_t crc, const void *data, const size_t len);
+
+/**
+ * Finalise a streaming IEEE 802.3 32-bit CRC computation.
+ *
+ * @param crc: current CRC state.
+ * @return 32-bit CRC.
+ */
+static inline uint32_t crc_32_final(const uint32_t crc)
+{
+    return crc ^ 0xFFFFFFFF;
+}
+
 #ifdef __cplusplus
 }
 #endif
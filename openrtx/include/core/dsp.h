@@ -47,6 +47,17 @@ typedef struct
 }
 filter_state_t;
 
+/**
+ * Data structure holding the internal state of a fixed-point filter.
+ */
+typedef struct
+{
+    int32_t u;          // previous input value u(k-1)
+    int32_t y;          // previous output value y(k-1), with eight fractional bits
+    bool    initialised;  // state variables initialised
+}
+filter_state_fixed_t;
+
 
 /**
  * Reset the filter state variables.
@@ -65,6 +76,25 @@ void dsp_resetFilterState(filter_state_t *state);
  */
 void dsp_dcRemoval(filter_state_t *state, audio_sample_t *buffer, size_t length);
 
+/**
+ * Reset the state variables of a fixed-point filter.
+ *
+ * @param state: pointer to the data structure containing the filter state.
+ */
+void dsp_resetFilterStateFixed(filter_state_fixed_t *state);
+
+/**
+ * Remove the DC offset from a collection of audio samples, processing data
+ * in-place. Fixed-point version of dsp_dcRemoval(), for targets without a
+ * floating point unit.
+ *
+ * @param state: pointer to the data structure containing the filter state.
+ * @param buffer: buffer containing the audio samples.
+ * @param length: number of samples contained in the buffer.
+ */
+void dsp_dcRemovalFixed(filter_state_fixed_t *state, audio_sample_t *buffer,
+                        size_t length);
+
 /*
  * Inverts the phase of the audio buffer passed as paramenter.
  * The buffer will be processed in place to save memory.
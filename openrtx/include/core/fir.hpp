@@ -32,6 +32,11 @@
 /**
  * Class for FIR filter with configurable coefficients.
  * Adapted from the original implementation by Rob Riggs, Mobilinkd LLC.
+ *
+ * The history of past input values is kept in a buffer twice the length of
+ * the filter, each input being stored both at position i and i + N. In this
+ * way the last N input values are always found in a contiguous region of
+ * memory and the convolution loop does not need any wrap-around of the index.
  */
 template < size_t N >
 class Fir
@@ -63,21 +68,175 @@ public:
      */
     float operator()(const float& input)
     {
-        hist[pos] = input;
-        pos = (pos + 1) % N;
+        return step(input);
+    }
 
-        float  result = 0.0;
-        size_t index  = pos;
+    /**
+     * Filter a block of samples, equivalent to calling operator() on each of
+     * them in sequence. Each input sample is multiplied by the given gain
+     * factor before being filtered. Input and output buffers can coincide, in
+     * which case the data is filtered in place.
+     *
+     * @param input: pointer to the block of input samples.
+     * @param output: pointer to the block where the output samples are stored.
+     * @param length: number of samples to be processed.
+     * @param gain: gain factor applied to the input samples.
+     */
+    template < typename T >
+    void process(const T *input, T *output, const size_t length,
+                 const float gain = 1.0f)
+    {
+        for(size_t i = 0; i < length; i++)
+        {
+            float elem = static_cast< float >(input[i]) * gain;
+            output[i]  = static_cast< T >(step(elem));
+        }
+    }
 
-        for(size_t i = 0; i < N; i++)
+    /**
+     * Reset FIR history, clearing the memory of past values.
+     */
+    void reset()
+    {
+        hist.fill(0);
+        pos = 0;
+    }
+
+private:
+
+    /**
+     * Push a new value in the history buffer and compute the filter output.
+     *
+     * @param input: FIR input value for the current time step.
+     * @return FIR output as a function of the current and past input values.
+     */
+    inline float step(const float input)
+    {
+        pos = (pos == 0) ? (N - 1) : (pos - 1);
+        hist[pos]     = input;
+        hist[pos + N] = input;
+
+        // The most recent value is at position pos, the oldest at pos + N - 1
+        return dotProduct(&hist[pos]);
+    }
+
+    /**
+     * Compute the dot product between the filter coefficients and the last N
+     * input values, starting from the most recent one.
+     *
+     * When CONFIG_FIR_UNROLL is defined, the loop is split over four partial
+     * accumulators to break the dependency chain between consecutive
+     * multiply-accumulate operations, allowing them to be pipelined by the FPU.
+     *
+     * @param h: pointer to the most recent sample in the history buffer.
+     * @return result of the dot product.
+     */
+    inline float dotProduct(const float *h) const
+    {
+        const float *t = taps.data();
+        size_t i = 0;
+
+        #ifdef CONFIG_FIR_UNROLL
+        float acc0 = 0.0f;
+        float acc1 = 0.0f;
+        float acc2 = 0.0f;
+        float acc3 = 0.0f;
+
+        for(; (i + 4) <= N; i += 4)
         {
-            index   = (index != 0 ? index - 1 : N - 1);
-            result += hist[index] * taps[i];
+            acc0 += h[i + 0] * t[i + 0];
+            acc1 += h[i + 1] * t[i + 1];
+            acc2 += h[i + 2] * t[i + 2];
+            acc3 += h[i + 3] * t[i + 3];
         }
 
+        float result = (acc0 + acc1) + (acc2 + acc3);
+        #else
+        float result = 0.0f;
+        #endif
+
+        for(; i < N; i++)
+            result += h[i] * t[i];
+
         return result;
     }
 
+    const std::array< float, N >& taps;    ///< FIR filter coefficients.
+    std::array< float, 2 * N >    hist;    ///< History of past inputs, doubled.
+    size_t                        pos;     ///< Current position in history.
+};
+
+/**
+ * Fixed-point version of the FIR filter, operating on 16-bit samples. Filter
+ * coefficients are converted to Q15 format at construction time and the
+ * convolution is carried out on a 64-bit accumulator, output values are
+ * rounded and saturated to the 16-bit range.
+ */
+template < size_t N >
+class FirFixed
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param taps: reference to a std::array of floating poing values representing
+     * the FIR filter coefficients, in the range [-1, 1).
+     */
+    FirFixed(const std::array< float, N >& taps) : pos(0)
+    {
+        for(size_t i = 0; i < N; i++)
+        {
+            float tap = taps[i] * 32768.0f;
+            if(tap >  32767.0f) tap =  32767.0f;
+            if(tap < -32768.0f) tap = -32768.0f;
+
+            // Round to nearest
+            tap += (tap >= 0.0f) ? 0.5f : -0.5f;
+            this->taps[i] = static_cast< int16_t >(tap);
+        }
+
+        reset();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~FirFixed() { }
+
+    /**
+     * Perform one step of the FIR filter, computing a new output value given
+     * the input value and the history of previous input values.
+     *
+     * @param input: FIR input value for the current time step.
+     * @return FIR output as a function of the current and past input values.
+     */
+    int16_t operator()(const int16_t input)
+    {
+        return step(input);
+    }
+
+    /**
+     * Filter a block of samples, equivalent to calling operator() on each of
+     * them in sequence. Each input sample is multiplied by the given integer
+     * gain factor before being filtered. Input and output buffers can coincide,
+     * in which case the data is filtered in place.
+     *
+     * @param input: pointer to the block of input samples.
+     * @param output: pointer to the block where the output samples are stored.
+     * @param length: number of samples to be processed.
+     * @param gain: gain factor applied to the input samples.
+     */
+    void process(const int16_t *input, int16_t *output, const size_t length,
+                 const int16_t gain = 1)
+    {
+        for(size_t i = 0; i < length; i++)
+        {
+            int32_t elem = static_cast< int32_t >(input[i]) * gain;
+            output[i]    = step(elem);
+        }
+    }
+
     /**
      * Reset FIR history, clearing the memory of past values.
      */
@@ -89,9 +248,34 @@ public:
 
 private:
 
-    const std::array< float, N >& taps;    ///< FIR filter coefficients.
-    std::array< float, N >        hist;    ///< History of past inputs.
-    size_t                        pos;     ///< Current position in history.
+    /**
+     * Push a new value in the history buffer and compute the filter output.
+     *
+     * @param input: FIR input value for the current time step.
+     * @return FIR output as a function of the current and past input values.
+     */
+    inline int16_t step(const int32_t input)
+    {
+        pos = (pos == 0) ? (N - 1) : (pos - 1);
+        hist[pos]     = input;
+        hist[pos + N] = input;
+
+        const int32_t *h   = &hist[pos];
+        int64_t        acc = 0;
+
+        for(size_t i = 0; i < N; i++)
+            acc += static_cast< int64_t >(h[i]) * taps[i];
+
+        acc = (acc + (1 << 14)) >> 15;
+        if(acc > INT16_MAX) acc = INT16_MAX;
+        if(acc < INT16_MIN) acc = INT16_MIN;
+
+        return static_cast< int16_t >(acc);
+    }
+
+    std::array< int16_t, N >     taps;    ///< FIR filter coefficients, Q15.
+    std::array< int32_t, 2 * N > hist;    ///< History of past inputs, doubled.
+    size_t                       pos;     ///< Current position in history.
 };
 
-#endif /* DSP_H */
+#endif /* FIR_H */
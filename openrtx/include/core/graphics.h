@@ -123,7 +123,7 @@ void gfx_terminate();
  * Copy a given section, between two given rows, of framebuffer content to the
  * display.
  * @param startRow: first row of the framebuffer section to be copied
- * @param endRow: last row of the framebuffer section to be copied
+ * @param endRow: row past the last one of the framebuffer section to be copied
  */
 void gfx_renderRows(uint8_t startRow, uint8_t endRow);
 
@@ -131,15 +131,26 @@ void gfx_renderRows(uint8_t startRow, uint8_t endRow);
  * This function calls the correspondent method of the low level interface display.h
  * Copy framebuffer content to the display internal buffer. To be called
  * whenever there is need to update the display.
+ * Only the bands of rows drawn since the previous call and whose content
+ * actually changed are sent to the display.
  */
 void gfx_render();
 
+/**
+ * Check if the display is still receiving the last rendered frame. On targets
+ * using a double buffered framebuffer, frames are sent to the display in
+ * background while the UI draws the next one.
+ *
+ * @return true if a frame transfer is in progress.
+ */
+bool gfx_renderingInProgress();
+
 /**
  * Clears a portion of the screen content
  * This results in a black screen on color displays
  * And a white screen on B/W displays
  * @param startRow: first row of the framebuffer section to be cleared
- * @param endRow: last row of the framebuffer section to be cleared
+ * @param endRow: row past the last one of the framebuffer section to be cleared
  */
 void gfx_clearRows(uint8_t startRow, uint8_t endRow);
 
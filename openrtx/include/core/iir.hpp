@@ -99,4 +99,100 @@ private:
     size_t                        pos;    ///< Current position in history.
 };
 
+/**
+ * Fixed-point version of the IIR filter, in direct form I. Filter coefficients
+ * are converted to Q30 format at construction time, thus they must lie in the
+ * range (-2, 2), and the first denominator coefficient is assumed to be one.
+ * Past output values are kept with eight fractional bits, to preserve the
+ * precision of filters with a very low cutoff frequency.
+ */
+template < size_t N >
+class IirFixed
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param num: coefficients of the IIR filter numerator.
+     * @param den: coefficients of the IIR filter denominator.
+     */
+    IirFixed(const std::array< float, N >& num, const std::array< float, N >& den)
+    {
+        for(size_t i = 0; i < N; i++)
+        {
+            this->num[i] = toQ30(num[i]);
+            this->den[i] = toQ30(den[i]);
+        }
+
+        reset();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~IirFixed() { }
+
+    /**
+     * Perform one step of the IIR filter, computing a new output value given
+     * the input value and the history of previous input and output values.
+     *
+     * @param input: IIR input value for the current time step.
+     * @return IIR output as a function of the current and past input values.
+     */
+    int32_t operator()(const int32_t input)
+    {
+        for(size_t i = N - 1; i > 0; i--)
+        {
+            u[i] = u[i - 1];
+            y[i] = y[i - 1];
+        }
+
+        u[0] = input;
+
+        int64_t acc = 0;
+        for(size_t i = 0; i < N; i++)
+            acc += static_cast< int64_t >(num[i]) * (u[i] * (1 << FRAC_BITS));
+
+        for(size_t i = 1; i < N; i++)
+            acc -= static_cast< int64_t >(den[i]) * y[i];
+
+        y[0] = static_cast< int32_t >((acc + (1 << 29)) >> 30);
+
+        return (y[0] + (1 << (FRAC_BITS - 1))) >> FRAC_BITS;
+    }
+
+    /**
+     * Reset IIR history, clearing the memory of past values.
+     */
+    void reset()
+    {
+        u.fill(0);
+        y.fill(0);
+    }
+
+private:
+
+    /**
+     * Convert a floating point value to Q30 format.
+     *
+     * @param value: value to be converted.
+     * @return value in Q30 format.
+     */
+    static int32_t toQ30(const float value)
+    {
+        float q = value * 1073741824.0f;
+        q += (q >= 0.0f) ? 0.5f : -0.5f;
+
+        return static_cast< int32_t >(q);
+    }
+
+    static constexpr size_t FRAC_BITS = 8;  ///< Fractional bits of output history.
+
+    std::array< int32_t, N > num;    ///< IIR filter numerator coefficients, Q30.
+    std::array< int32_t, N > den;    ///< IIR filter denominator coefficients, Q30.
+    std::array< int32_t, N > u;      ///< History of past inputs.
+    std::array< int32_t, N > y;      ///< History of past outputs.
+};
+
 #endif /* IIR_H */
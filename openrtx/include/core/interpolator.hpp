@@ -0,0 +1,120 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef INTERPOLATOR_H
+#define INTERPOLATOR_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Class for polyphase FIR interpolator, upsampling the input by an integer
+ * factor L.
+ *
+ * The result is the same as zero-stuffing the input with L - 1 zeroes between
+ * each sample and then filtering it with an N-taps FIR filter but, being the
+ * stuffed samples always zero, the filter is split in L branches of N/L taps
+ * each and only the products with the non-zero samples are computed.
+ * Branch p computes the output samples at positions p, p + L, p + 2L, ... using
+ * the taps p, p + L, p + 2L, ...
+ */
+template < size_t N, size_t L >
+class Interpolator
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param taps: reference to a std::array of floating point values
+     * representing the coefficients of the interpolation FIR filter.
+     */
+    Interpolator(const std::array< float, N >& taps) : pos(0)
+    {
+        for(size_t p = 0; p < L; p++)
+        {
+            for(size_t k = 0; k < M; k++)
+            {
+                size_t idx = p + (k * L);
+                branches[p][k] = (idx < N) ? taps[idx] : 0.0f;
+            }
+        }
+
+        reset();
+    }
+
+    /**
+     * Destructor.
+     */
+    ~Interpolator() { }
+
+    /**
+     * Push a new input sample into the interpolator and compute the
+     * corresponding L output samples.
+     *
+     * @param input: interpolator input value for the current time step.
+     * @param output: pointer to a buffer of at least L elements where the
+     * output samples are stored.
+     */
+    void operator()(const float input, float *output)
+    {
+        pos = (pos == 0) ? (M - 1) : (pos - 1);
+        hist[pos]     = input;
+        hist[pos + M] = input;
+
+        // The most recent value is at position pos, the oldest at pos + M - 1
+        const float *h = &hist[pos];
+
+        for(size_t p = 0; p < L; p++)
+        {
+            const float *t = branches[p].data();
+            float result   = 0.0f;
+
+            for(size_t k = 0; k < M; k++)
+                result += h[k] * t[k];
+
+            output[p] = result;
+        }
+    }
+
+    /**
+     * Reset the interpolator history, clearing the memory of past values.
+     */
+    void reset()
+    {
+        hist.fill(0);
+        pos = 0;
+    }
+
+private:
+
+    static constexpr size_t M = (N + L - 1) / L;   ///< Number of taps per branch.
+
+    std::array< std::array< float, M >, L > branches;  ///< Polyphase filter branches.
+    std::array< float, 2 * M >              hist;      ///< History of past inputs, doubled.
+    size_t                                  pos;       ///< Current position in history.
+};
+
+#endif /* INTERPOLATOR_H */
@@ -0,0 +1,115 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <interfaces/audio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Polyphase sample rate converter for audio streams.
+ *
+ * The conversion is performed by upsampling the input by an integer factor L,
+ * filtering and then downsampling by an integer factor M, with L/M being the
+ * ratio between the output and input sample rates reduced to the lowest
+ * terms. The filter is split in L branches and, for each output sample, only
+ * the branch corresponding to its position between two input samples is
+ * computed: integer upsampling (M = 1) and integer downsampling (L = 1) come
+ * without any extra computation with respect to a plain interpolator or
+ * decimator.
+ */
+
+/**
+ * Maximum value for the interpolation and decimation factors.
+ */
+#define RESAMPLER_MAX_FACTOR 8
+
+/**
+ * Number of filter taps for each unit of the largest between the
+ * interpolation and decimation factors.
+ */
+#define RESAMPLER_ORDER      8
+
+#define RESAMPLER_MAX_TAPS   (RESAMPLER_MAX_FACTOR * RESAMPLER_ORDER)
+
+/**
+ * Size of the branch-split filter: each of the L branches is padded with zeros
+ * to the length of the longest one, adding up to L - 1 taps.
+ */
+#define RESAMPLER_TAPS_SIZE  (RESAMPLER_MAX_TAPS + RESAMPLER_MAX_FACTOR - 1)
+
+/**
+ * Sample rate converter state.
+ */
+struct resampler
+{
+    uint16_t up;                             ///< Interpolation factor.
+    uint16_t down;                           ///< Decimation factor.
+    uint16_t branchLen;                      ///< Length of a filter branch.
+    uint16_t phase;                          ///< Current filter branch.
+    uint16_t pos;                            ///< Current history position.
+    int16_t  taps[RESAMPLER_TAPS_SIZE];      ///< Filter taps, in Q15 format.
+    int16_t  hist[2 * RESAMPLER_MAX_TAPS];   ///< Input history.
+};
+
+/**
+ * Initialise a sample rate converter.
+ *
+ * @param rs: pointer to the resampler state.
+ * @param inRate: input sample rate.
+ * @param outRate: output sample rate.
+ * @return zero on success, -EINVAL if the conversion ratio is not supported.
+ */
+int resampler_init(struct resampler *rs, const uint32_t inRate,
+                   const uint32_t outRate);
+
+/**
+ * Reset the internal state of a sample rate converter, clearing the history
+ * of the input samples.
+ *
+ * @param rs: pointer to the resampler state.
+ */
+void resampler_reset(struct resampler *rs);
+
+/**
+ * Convert a block of samples. The output buffer must be large enough to hold
+ * all the samples generated from the input ones, that is the length of the
+ * input block multiplied by the conversion ratio and rounded up.
+ *
+ * @param rs: pointer to the resampler state.
+ * @param in: input samples.
+ * @param inLen: number of input samples.
+ * @param out: buffer where the output samples are stored.
+ * @return number of output samples generated.
+ */
+size_t resampler_process(struct resampler *rs, const stream_sample_t *in,
+                         const size_t inLen, stream_sample_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RESAMPLER_H */
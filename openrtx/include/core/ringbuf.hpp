@@ -27,10 +27,18 @@
 
 #include <pthread.h>
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
 
 /**
- * Class implementing a statically allocated circular buffer with blocking and
- * non-blocking push and pop functions.
+ * Class implementing a statically allocated, lock-free, single-producer single-
+ * consumer circular buffer with blocking and non-blocking push and pop
+ * functions.
+ *
+ * Only one thread at a time can push data into the buffer and only one thread
+ * at a time can pop data from it. Read and write indices are updated with
+ * acquire/release semantics, the mutex and condition variable are used only
+ * when a blocking call has to wait for the other side.
  */
 template < typename T, size_t N >
 class RingBuffer
@@ -40,11 +48,10 @@ public:
     /**
      * Constructor.
      */
-    RingBuffer() : readPos(0), writePos(0), numElements(0)
+    RingBuffer() : readPos(0), writePos(0), consWaiting(false), prodWaiting(false)
     {
         pthread_mutex_init(&mutex, NULL);
-        pthread_cond_init(&not_empty, NULL);
-        pthread_cond_init(&not_full, NULL);
+        pthread_cond_init(&cond, NULL);
     }
 
     /**
@@ -53,50 +60,40 @@ public:
     ~RingBuffer()
     {
         pthread_mutex_destroy(&mutex);
-        pthread_cond_destroy(&not_empty);
-        pthread_cond_destroy(&not_full);
+        pthread_cond_destroy(&cond);
     }
 
     /**
-     * Push an element to the buffer.
+     * Push an element to the buffer. Must be called only by the producer side.
      *
      * @param elem: element to be pushed.
      * @param blocking: if set to true, when the buffer is full this function
      * blocks the execution flow until at least one empty slot is available.
      * @return true if the element has been successfully pushed to the queue,
-     * false if the queue is empty.
+     * false if the queue is full.
      */
     bool push(const T& elem, bool blocking)
     {
-        pthread_mutex_lock(&mutex);
+        size_t wr   = writePos.load(std::memory_order_relaxed);
+        size_t next = increment(wr);
 
-        if((numElements >= N) && (blocking == false))
+        while(next == readPos.load(std::memory_order_acquire))
         {
-            // No space available and non-blocking call: unlock mutex and return
-            pthread_mutex_unlock(&mutex);
-            return false;
-        }
+            if(blocking == false)
+                return false;
 
-        // The call is blocking: wait until there is some free space
-        while(numElements >= N)
-        {
-            pthread_cond_wait(&not_full, &mutex);
+            waitFor(prodWaiting, [&]{ return next != readPos.load(std::memory_order_acquire); });
         }
 
-        // There is free space, push data into the queue
-        data[writePos] = elem;
-        writePos = (writePos + 1) % N;
+        data[wr] = elem;
+        writePos.store(next, std::memory_order_release);
+        notify(consWaiting);
 
-        // Signal that the queue is not empty
-        if(numElements == 0) pthread_cond_signal(&not_empty);
-        numElements += 1;
-
-        pthread_mutex_unlock(&mutex);
         return true;
     }
 
     /**
-     * Pop an element from the buffer.
+     * Pop an element from the buffer. Must be called only by the consumer side.
      *
      * @param elem: place where to store the popped element.
      * @param blocking: if set to true, when the buffer is empty this function
@@ -106,30 +103,19 @@ public:
      */
     bool pop(T& elem, bool blocking)
     {
-        pthread_mutex_lock(&mutex);
+        size_t rd = readPos.load(std::memory_order_relaxed);
 
-        if((numElements == 0) && (blocking == false))
+        while(rd == writePos.load(std::memory_order_acquire))
         {
-            // No elements present and non-blocking call: unlock mutex and return
-            pthread_mutex_unlock(&mutex);
-            return false;
-        }
+            if(blocking == false)
+                return false;
 
-        // The call is blocking: wait until there is something into the queue
-        while(numElements == 0)
-        {
-            pthread_cond_wait(&not_empty, &mutex);
+            waitFor(consWaiting, [&]{ return rd != writePos.load(std::memory_order_acquire); });
         }
 
-        // At least one element present pop one.
-        elem    = data[readPos];
-        readPos = (readPos + 1) % N;
-
-        // Signal that the queue is no more full
-        if(numElements >= N) pthread_cond_signal(&not_full);
-        numElements -= 1;
-
-        pthread_mutex_unlock(&mutex);
+        elem = data[rd];
+        readPos.store(increment(rd), std::memory_order_release);
+        notify(prodWaiting);
 
         return true;
     }
@@ -141,7 +127,8 @@ public:
      */
     bool empty()
     {
-        return numElements == 0;
+        return readPos.load(std::memory_order_acquire)
+            == writePos.load(std::memory_order_acquire);
     }
 
     /**
@@ -151,54 +138,124 @@ public:
      */
     bool full()
     {
-        return numElements >= N;
+        size_t next = increment(writePos.load(std::memory_order_acquire));
+        return next == readPos.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Get the number of elements currently stored in the buffer.
+     *
+     * @return number of elements in the buffer.
+     */
+    size_t size()
+    {
+        size_t rd = readPos.load(std::memory_order_acquire);
+        size_t wr = writePos.load(std::memory_order_acquire);
+
+        if(wr >= rd)
+            return wr - rd;
+
+        return (N + 1) - (rd - wr);
     }
 
     /**
      * Discard one element from the buffer's tail, creating a new empty slot.
      * In case the buffer is full calling this function unlocks the eventual
      * threads waiting to push data.
+     *
+     * This function moves the read pointer: it has to be called either by the
+     * consumer side or when the consumer is known not to be accessing the
+     * buffer.
      */
     void eraseElement()
     {
+        size_t rd = readPos.load(std::memory_order_relaxed);
+
         // Nothing to erase
-        if(numElements == 0) return;
+        if(rd == writePos.load(std::memory_order_acquire))
+            return;
 
-        pthread_mutex_lock(&mutex);
+        readPos.store(increment(rd), std::memory_order_release);
+        notify(prodWaiting);
+    }
 
-        // Chomp away one element just by advancing the read pointer.
-        readPos = (readPos + 1) % N;
+    /**
+     * Reset the buffer to its empty state discarding all the elements stored.
+     * This function is not thread safe and must be called only when neither
+     * the producer nor the consumer are accessing the buffer.
+     *
+     * Note: reset is "lazy", as it just sets read pointer and write pointer to
+     * zero. No actual erasure of the stored elements is done until they are
+     * effectively overwritten by new push()es.
+     */
+    void reset()
+    {
+        readPos.store(0);
+        writePos.store(0);
+    }
 
-        if(numElements >= N) pthread_cond_signal(&not_full);
-        numElements -= 1;
+private:
 
+    /**
+     * Advance a buffer index by one position, wrapping around at the end of
+     * the storage.
+     *
+     * @param pos: index to be advanced.
+     * @return advanced index.
+     */
+    static inline size_t increment(const size_t pos)
+    {
+        return (pos >= N) ? 0 : pos + 1;
+    }
+
+    /**
+     * Block the calling thread until a given condition becomes true. The
+     * waiting flag and the condition are checked under the mutex, ensuring that
+     * a notification coming from the other side is never lost.
+     *
+     * @param flag: waiting flag of the calling side.
+     * @param ready: function returning true when the waited condition is met.
+     */
+    template < typename F >
+    void waitFor(std::atomic< bool >& flag, F ready)
+    {
+        pthread_mutex_lock(&mutex);
+        flag.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        while(ready() == false)
+            pthread_cond_wait(&cond, &mutex);
+
+        flag.store(false, std::memory_order_relaxed);
         pthread_mutex_unlock(&mutex);
     }
 
     /**
-     * Reset the buffer to its empty state discarding all the elements stored.
+     * Wake up the other side if it is waiting for data or free space.
      *
-     * Note: reset is "lazy", as it just sets read pointer, write pointer and
-     * number of elements to zero. No actual erasure of the stored elements is
-     * done until they are effectively overwritten by new push()es.
+     * @param flag: waiting flag of the other side.
      */
-    void reset()
+    void notify(std::atomic< bool >& flag)
     {
-        readPos     = 0;
-        writePos    = 0;
-        numElements = 0;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(flag.load(std::memory_order_relaxed) == false)
+            return;
+
+        pthread_mutex_lock(&mutex);
+        pthread_cond_signal(&cond);
+        pthread_mutex_unlock(&mutex);
     }
 
-private:
+    static constexpr size_t CACHE_LINE = 32;    ///< Size of a cache line, in bytes.
 
-    size_t readPos;      ///< Read pointer.
-    size_t writePos;     ///< Write pointer.
-    size_t numElements;  ///< Number of elements currently present.
-    T      data[N];      ///< Data storage.
+    alignas(CACHE_LINE) std::atomic< size_t > readPos;    ///< Read pointer, owned by the consumer.
+    alignas(CACHE_LINE) std::atomic< size_t > writePos;   ///< Write pointer, owned by the producer.
+    alignas(CACHE_LINE) std::atomic< bool >   consWaiting;  ///< Consumer is waiting for data.
+    std::atomic< bool >                       prodWaiting;  ///< Producer is waiting for space.
+    T data[N + 1];                                        ///< Data storage, one slot always empty.
 
-    pthread_mutex_t mutex;      ///< Mutex for concurrent access.
-    pthread_cond_t  not_empty;  ///< Queue not empty condition.
-    pthread_cond_t  not_full;   ///< Queue not full condition.
+    pthread_mutex_t mutex;  ///< Mutex for blocking wait.
+    pthread_cond_t  cond;   ///< Condition variable for blocking wait.
 };
 
 #endif  // RINGBUF_H
@@ -48,4 +48,9 @@ void create_threads();
  */
 #define CODEC2_TASK_STKSIZE 16384
 
+/**
+ * Stack size for audio mixer task, in bytes.
+ */
+#define MIXER_TASK_STKSIZE 1024
+
 #endif /* THREADS_H */
@@ -185,6 +185,10 @@ voicePrompt_t;
 // The name of the voice prompt file is always encoded as the last prompt.
 #define PROMPT_VOICE_NAME (NUM_VOICE_PROMPTS + (sizeof(stringsTable_t)/sizeof(char*)))
 
+// Size of the table of contents of the voice prompt data file, that is the
+// maximum number of voice prompts.
+#define VOICE_PROMPTS_TOC_SIZE 350
+
 /**
  * Flags controlling how vp_queueString operates.
  */
@@ -0,0 +1,108 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef VP_PCM_CACHE_H
+#define VP_PCM_CACHE_H
+
+#include <interfaces/audio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Cache of decoded PCM audio for the most used voice prompts.
+ *
+ * Each use of a prompt is counted and, when a prompt not in the cache is used
+ * more than the least used cached one, a cache entry is reserved for it. The
+ * entry is replaced, or taken among the empty ones, and it is filled with the
+ * audio decoded by the codec thread the next time the prompt is played. Only
+ * one entry at a time can be reserved.
+ *
+ * The cache is disabled by default: VP_PCM_CACHE_ENTRIES sets the number of
+ * cached prompts while VP_PCM_CACHE_SAMPLES sets the maximum length of a cached
+ * prompt, in 8kHz samples. The cache is not thread safe and is meant to be used
+ * from the voice prompt manager.
+ */
+
+#ifndef VP_PCM_CACHE_ENTRIES
+#define VP_PCM_CACHE_ENTRIES   0
+#endif
+#ifndef VP_PCM_CACHE_SAMPLES
+#define VP_PCM_CACHE_SAMPLES   4000
+#endif
+
+/**
+ * Entry of the PCM cache.
+ */
+typedef struct
+{
+    uint16_t        prompt;                         ///< Prompt number.
+    uint16_t        length;                         ///< Length, zero if empty.
+    stream_sample_t samples[VP_PCM_CACHE_SAMPLES];  ///< Decoded audio.
+}
+vpPcmEntry_t;
+
+/**
+ * Empty the cache and clear the usage count of all the prompts.
+ */
+void vpPcmCache_reset();
+
+/**
+ * Search a voice prompt inside the cache.
+ *
+ * @param prompt: prompt number.
+ * @return pointer to the cache entry or NULL if the prompt is not cached.
+ */
+vpPcmEntry_t *vpPcmCache_find(const uint16_t prompt);
+
+/**
+ * Count a use of a voice prompt and, if it ranks among the most used ones but
+ * it is not in the cache, reserve an entry for it.
+ *
+ * @param prompt: prompt number.
+ * @param frames: length of the prompt, in codec2 frames of 160 samples.
+ * @return pointer to the cache entry or NULL if the prompt is not cached.
+ */
+vpPcmEntry_t *vpPcmCache_get(const uint16_t prompt, const uint32_t frames);
+
+/**
+ * Get the entry reserved to be filled.
+ *
+ * @return pointer to the reserved entry or NULL if none is reserved.
+ */
+vpPcmEntry_t *vpPcmCache_reserved();
+
+/**
+ * Terminate the filling of the reserved entry, releasing the reservation. The
+ * entry becomes valid only if all the frames of its prompt have been stored,
+ * otherwise it is left empty.
+ *
+ * @param frames: number of frames stored in the entry.
+ */
+void vpPcmCache_endFill(const uint32_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VP_PCM_CACHE_H */
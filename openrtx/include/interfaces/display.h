@@ -67,13 +67,45 @@ void display_terminate();
 /**
  * Copy a given section, between two given rows, of framebuffer content to the
  * display. This function blocks the caller until render is completed.
+ * Rows are expressed in pixels, drivers for displays organised in pages of
+ * rows round the section outwards to whole pages. The framebuffer content must
+ * be left unchanged, since the same rows may be sent again later.
  *
  * @param startRow: first row of the framebuffer section to be copied
- * @param endRow: last row of the framebuffer section to be copied
+ * @param endRow: row past the last one of the framebuffer section to be copied
  * @param fb: pointer to frameBuffer.
  */
 void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb);
 
+/**
+ * Start copying a given section, between two given rows, of framebuffer
+ * content to the display and return without waiting for the copy to complete.
+ * If a previous copy is still in progress, the caller is blocked until it
+ * ends. The framebuffer section must not be accessed until display_waitRender()
+ * returns.
+ * This function is provided only by drivers supporting asynchronous transfers,
+ * that is on targets enabling CONFIG_GFX_DOUBLE_BUFFER.
+ *
+ * @param startRow: first row of the framebuffer section to be copied
+ * @param endRow: row past the last one of the framebuffer section to be copied
+ * @param fb: pointer to frameBuffer.
+ */
+void display_renderRowsAsync(uint8_t startRow, uint8_t endRow, void *fb);
+
+/**
+ * Block the caller until the copy started by display_renderRowsAsync()
+ * completes and give the framebuffer section back to the caller. Returns
+ * immediately if no copy is in progress.
+ */
+void display_waitRender();
+
+/**
+ * Check if a framebuffer copy to the display is in progress.
+ *
+ * @return true if the display is being written.
+ */
+bool display_renderingInProgress();
+
 /**
  * Copy framebuffer content to the display internal buffer, to be called
  * whenever there is need to update the display.
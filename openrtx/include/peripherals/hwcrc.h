@@ -0,0 +1,56 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef HWCRC_H
+#define HWCRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Driver for hardware CRC computation units.
+ *
+ * This interface is used by the CRC engine when the CONFIG_CRC_HW macro is
+ * defined, the driver is in charge of enabling and disabling the peripheral
+ * and of arbitrating its access between threads.
+ */
+
+/**
+ * Update an IEEE 802.3 32-bit CRC computation using the hardware CRC unit.
+ * The CRC state has the same format used by crc_32_update(). If the hardware
+ * unit is already in use, the function returns immediately without processing
+ * any data, leaving the computation to the software implementation.
+ *
+ * @param crc: pointer to the current CRC state, updated with the new value.
+ * @param data: input data, must be aligned to a 32-bit boundary.
+ * @param len: data length, in bytes, must be a multiple of four.
+ * @return number of bytes processed.
+ */
+size_t hwcrc_crc32(uint32_t *crc, const void *data, const size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HWCRC_H */
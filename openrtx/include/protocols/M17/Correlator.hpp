@@ -23,12 +23,19 @@
 #define CORRELATOR_H
 
 #include <cstdint>
+#include <cstddef>
+#include <utility>
 #include <array>
 
 /**
  * Class to construct correlator objects, allowing to compute the cross-correlation
  * between a stream of signed 16-bit samples and a known syncword.
  * The correlator has its internal storage for past samples.
+ *
+ * Samples are stored split by their phase within the symbol period, so that
+ * the samples involved in a convolution are adjacent in memory. Each phase
+ * buffer is doubled to keep the last SYNCW_SIZE samples always contiguous,
+ * avoiding any wrap-around in the convolution loops.
  */
 template < size_t SYNCW_SIZE, size_t SAMPLES_PER_SYM >
 class Correlator
@@ -38,13 +45,28 @@ public:
     /**
      * Constructor.
      */
-    Correlator() : sampIdx(0) { }
+    Correlator()
+    {
+        reset();
+    }
 
     /**
      * Destructor.
      */
     ~Correlator() { }
 
+    /**
+     * Clear the correlator memory.
+     */
+    void reset()
+    {
+        for(auto& buf : samples)
+            buf.fill(0);
+
+        phase  = SAMPLES_PER_SYM - 1;
+        symIdx = SYNCW_SIZE - 1;
+    }
+
     /**
      * Append a new sample to the correlator memory.
      *
@@ -52,9 +74,17 @@ public:
      */
     void sample(const int16_t sample)
     {
-        samples[sampIdx] = sample;
-        prevIdx = sampIdx;
-        sampIdx = (sampIdx + 1) % SYNCWORD_SAMPLES;
+        phase += 1;
+        if(phase >= SAMPLES_PER_SYM)
+        {
+            phase   = 0;
+            symIdx += 1;
+            if(symIdx >= SYNCW_SIZE)
+                symIdx = 0;
+        }
+
+        samples[phase][symIdx]              = sample;
+        samples[phase][symIdx + SYNCW_SIZE] = sample;
     }
 
     /**
@@ -66,13 +96,34 @@ public:
      */
     int32_t convolve(const std::array< int8_t, SYNCW_SIZE >& syncword)
     {
+        const int16_t *window = symbols(phase);
         int32_t conv = 0;
-        size_t  pos  = prevIdx + SAMPLES_PER_SYM;
 
-        for(auto& sym : syncword)
+        for(size_t i = 0; i < SYNCW_SIZE; i++)
+            conv += (int32_t) syncword[i] * (int32_t) window[i];
+
+        return conv;
+    }
+
+    /**
+     * Compute the convolution product between the samples stored in the correlator
+     * memory and a set of target syncwords, in a single pass over the samples.
+     *
+     * @param syncwords: symbols of the syncwords.
+     * @return convolution products, one for each syncword.
+     */
+    template < size_t N >
+    std::array< int32_t, N > convolve(const std::array< std::array< int8_t, SYNCW_SIZE >, N >& syncwords)
+    {
+        const int16_t *window = symbols(phase);
+        std::array< int32_t, N > conv;
+        conv.fill(0);
+
+        for(size_t i = 0; i < SYNCW_SIZE; i++)
         {
-            conv += (int32_t) sym * (int32_t) samples[pos % SYNCWORD_SAMPLES];
-            pos  += SAMPLES_PER_SYM;
+            int32_t value = window[i];
+            for(size_t j = 0; j < N; j++)
+                conv[j] += (int32_t) syncwords[j][i] * value;
         }
 
         return conv;
@@ -92,27 +143,25 @@ public:
      */
     std::pair< int32_t, int32_t > maxDeviation(const uint8_t samplePoint)
     {
+        const int16_t *window = symbols(samplePoint);
         int32_t maxSum = 0;
         int32_t minSum = 0;
         int32_t maxCnt = 0;
         int32_t minCnt = 0;
 
-        for(size_t i = 0; i < SYNCWORD_SAMPLES; i++)
+        for(size_t i = 0; i < SYNCW_SIZE; i++)
         {
-            if(((prevIdx + i) % SAMPLES_PER_SYM) == samplePoint)
+            int16_t sample = window[i];
+            if(sample > 0)
             {
-                int16_t sample = samples[(prevIdx + i) % SYNCWORD_SAMPLES];
-                if(sample > 0)
-                {
-                    maxSum += sample;
-                    maxCnt += 1;
-                }
-
-                if(sample < 0)
-                {
-                    minSum += sample;
-                    minCnt += 1;
-                }
+                maxSum += sample;
+                maxCnt += 1;
+            }
+
+            if(sample < 0)
+            {
+                minSum += sample;
+                minCnt += 1;
             }
         }
 
@@ -123,24 +172,22 @@ public:
     }
 
     /**
-     * Access the internal sample memory.
+     * Access the last SYNCW_SIZE samples stored in the correlator memory
+     * having a given phase within the symbol period, ordered from the oldest
+     * to the most recent one.
      *
-     * @return a pointer to the correlator memory.
+     * @param samplePoint: sample phase, from zero to SAMPLES_PER_SYM - 1.
+     * @return a pointer to the samples.
      */
-    const int16_t *data()
+    const int16_t *symbols(const size_t samplePoint)
     {
-        return samples;
-    }
+        // Phases after the current one have been last written during the
+        // previous symbol period.
+        size_t start = symIdx + 1;
+        if(samplePoint > phase)
+            start = symIdx;
 
-    /**
-     * Get the buffer index at which the last sample has been written. The index
-     * goes from zero to (SYNCW_SIZE * SAMPLES_PER_SYM) - 1.
-     *
-     * @return index of the last stored sample.
-     */
-    size_t index()
-    {
-        return prevIdx;
+        return &samples[samplePoint][start];
     }
 
     /**
@@ -151,16 +198,16 @@ public:
      */
     size_t sampleIndex()
     {
-        return prevIdx % SAMPLES_PER_SYM;
+        return phase;
     }
 
 private:
 
-    static constexpr size_t SYNCWORD_SAMPLES = SYNCW_SIZE * SAMPLES_PER_SYM;
+    using phaseBuf_t = std::array< int16_t, 2 * SYNCW_SIZE >;
 
-    int16_t samples[SYNCWORD_SAMPLES];  ///< Samples' storage
-    size_t  sampIdx;                    ///< Index of the next sample to write
-    size_t  prevIdx;                    ///< Index of the last written sample
+    std::array< phaseBuf_t, SAMPLES_PER_SYM > samples; ///< Samples' storage, by phase
+    size_t phase;                                     ///< Phase of the last written sample
+    size_t symIdx;                                    ///< Symbol index of the last written sample
 };
 
 #endif
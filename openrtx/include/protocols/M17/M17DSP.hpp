@@ -27,6 +27,7 @@
 #error This header is C++ only!
 #endif
 
+#include <hwconfig.h>
 #include <fir.hpp>
 #include <array>
 
@@ -86,10 +87,17 @@ static constexpr std::array<float, 41> rrc_taps_24k =
 };
 
 /*
- * FIR implementations of the RRC filter for baseband audio generation.
+ * FIR implementations of the RRC filter for baseband audio generation. When
+ * CONFIG_M17_FIXED_POINT is defined, the receive-side filter is implemented
+ * in fixed-point arithmetic.
  */
 extern Fir< std::tuple_size< decltype(rrc_taps_48k) >::value > rrc_48k;
+
+#ifdef CONFIG_M17_FIXED_POINT
+extern FirFixed< std::tuple_size< decltype(rrc_taps_24k) >::value > rrc_24k;
+#else
 extern Fir< std::tuple_size< decltype(rrc_taps_24k) >::value > rrc_24k;
+#endif
 
 } /* M17 */
 
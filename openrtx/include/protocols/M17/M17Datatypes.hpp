@@ -37,6 +37,13 @@ using lich_t    = std::array< uint8_t, 12 >;   // Data type for Golay(24,12) enc
 using frame_t   = std::array< uint8_t, 48 >;   // Data type for a full M17 data frame, including sync word
 using syncw_t   = std::array< uint8_t, 2  >;   // Data type for a sync word
 
+// Data type for a full M17 data frame, including sync word, as soft bits.
+// Each bit ranges from 0x0000 (certainly zero) to 0xFFFF (certainly one).
+using softFrame_t = std::array< uint16_t, 384 >;
+
+// Data type for Golay(24,12) encoded LICH data, as soft bits.
+using softLich_t  = std::array< uint16_t, 96 >;
+
 enum M17DataMode
 {
     M17_DATAMODE_PACKET = 0,
@@ -30,6 +30,7 @@
 #include <experimental/array>
 #include <string>
 #include <array>
+#include "M17Utils.hpp"
 
 namespace M17
 {
@@ -62,6 +63,21 @@ inline void decorrelate(std::array< uint8_t, N >& data)
     }
 }
 
+/**
+ * Apply M17 decorrelation scheme to an array of soft bits.
+ *
+ * \param data: soft bit array to be decorrelated.
+ */
+template <size_t N >
+inline void decorrelate(std::array< uint16_t, N >& data)
+{
+    for (size_t i = 0; i < N; i++)
+    {
+        if(getBit(sequence, i))
+            data[i] = 0xFFFF - data[i];
+    }
+}
+
 }      // namespace M17
 
 #endif // M17_DECORRELATOR_H
@@ -27,6 +27,7 @@
 #error This header is C++ only!
 #endif
 
+#include <hwconfig.h>
 #include <iir.hpp>
 #include <cstdint>
 #include <cstddef>
@@ -38,6 +39,7 @@
 #include <audio_stream.h>
 #include <M17/M17Datatypes.hpp>
 #include <M17/M17Constants.hpp>
+#include <M17/M17DSP.hpp>
 #include <M17/Correlator.hpp>
 #include <M17/Synchronizer.hpp>
 
@@ -86,6 +88,14 @@ public:
      */
     const frame_t& getFrame();
 
+    /**
+     * Returns the last frame decoded from the baseband signal, as soft bits.
+     *
+     * @return reference to the internal data structure containing the last
+     * decoded frame, in soft bit format.
+     */
+    const softFrame_t& getSoftFrame();
+
     /**
      * Demodulates data from the ADC and fills the idle frame.
      * Everytime this function is called a whole ADC buffer is consumed.
@@ -95,6 +105,20 @@ public:
      */
     bool update(const bool invertPhase = false);
 
+    /**
+     * Demodulates a block of baseband samples sampled at 24kHz, without
+     * going through the baseband input stream. Samples are processed in place.
+     * This function allows to run more demodulator instances on data coming
+     * from other sources than the radio.
+     *
+     * @param samples: baseband samples, modified by the function.
+     * @param length: number of samples.
+     * @param invertPhase: invert the phase of the baseband signal before decoding.
+     * @return true if a new frame has been fully decoded.
+     */
+    bool process(int16_t *samples, const size_t length,
+                 const bool invertPhase = false);
+
     /**
      * @return true if a demodulator is locked on an M17 stream.
      */
@@ -104,8 +128,9 @@ private:
 
     /**
      * Quantize a given sample to its corresponding symbol and append it to the
-     * ongoing frame. When a frame is complete, it swaps the pointers and updates
-     * newFrame variable.
+     * ongoing frame, together with the soft bits derived from the sample value.
+     * When a frame is complete, it swaps the pointers and updates newFrame
+     * variable.
      *
      * @param sample: baseband sample.
      * @return quantized symbol.
@@ -117,6 +142,24 @@ private:
      */
     void reset();
 
+    /**
+     * Update the frame synchronizers, computing the correlation of the samples
+     * with all the M17 syncwords in a single pass.
+     *
+     * @param threshold: correlation threshold for peak detection.
+     * @return true if a correlation peak has been found. In this case the
+     * corresponding sampling index is stored in syncIndex.
+     */
+    bool updateSync(const int32_t threshold);
+
+    /**
+     * Compute the minimum hamming distance between the syncword of the frame
+     * being demodulated and the M17 syncwords.
+     *
+     * @return minimum hamming distance.
+     */
+    uint8_t syncwordDistance();
+
     /**
      * M17 baseband signal sampled at 24kHz, half of an M17 frame is processed
      * at each update of the demodulator.
@@ -145,12 +188,26 @@ private:
     static constexpr std::array < float, 3 > sfNum = {4.24433681e-05f, 8.48867363e-05f, 4.24433681e-05f};
     static constexpr std::array < float, 3 > sfDen = {1.0f,           -1.98148851f,     0.98165828f};
 
+    /**
+     * Symbols of the syncwords used for frame synchronization. Being the LSF
+     * and BERT syncwords the negated version of the stream and packet ones,
+     * they are found as negative correlation peaks.
+     */
+    using syncSymbols_t = std::array< int8_t, M17_SYNCWORD_SYMBOLS >;
+    static constexpr std::array< syncSymbols_t, 2 > syncSymbols =
+    {{
+        { -3, -3, -3, -3, +3, +3, -3, +3 },     // Stream (LSF when negated)
+        { +3, -3, +3, +3, -3, -3, -3, -3 }      // Packet (BERT when negated)
+    }};
+
     DemodState                     demodState;      ///< Demodulator state
     std::unique_ptr< int16_t[] >   baseband_buffer; ///< Buffer for baseband audio handling.
     streamId                       basebandId;      ///< Id of the baseband input stream.
     pathId                         basebandPath;    ///< Id of the baseband input path.
     std::unique_ptr<frame_t >      demodFrame;      ///< Frame being demodulated.
     std::unique_ptr<frame_t >      readyFrame;      ///< Fully demodulated frame to be returned.
+    std::unique_ptr<softFrame_t >  demodSoftFrame;  ///< Soft bits of the frame being demodulated.
+    std::unique_ptr<softFrame_t >  readySoftFrame;  ///< Soft bits of the fully demodulated frame.
     bool                           locked;          ///< A syncword was correctly demodulated.
     bool                           newFrame;        ///< A new frame has been fully decoded.
     uint16_t                       frameIndex;      ///< Index for filling the raw frame.
@@ -160,13 +217,32 @@ private:
     uint8_t                        missedSyncs;     ///< Counter of missed synchronizations
     uint32_t                       initCount;       ///< Downcounter for initialization
     uint32_t                       syncCount;       ///< Downcounter for resynchronization
+    uint32_t                       syncIndex;       ///< Sampling index of the last syncword found
     std::pair < int32_t, int32_t > outerDeviation;  ///< Deviation of outer symbols
+    #ifdef CONFIG_M17_FIXED_POINT
+    int32_t                        corrThreshold;   ///< Correlation threshold
+    filter_state_fixed_t           dcrState;        ///< State of the DC removal filter
+    #else
     float                          corrThreshold;   ///< Correlation threshold
     filter_state_t                 dcrState;        ///< State of the DC removal filter
+    #endif
 
     Correlator   < M17_SYNCWORD_SYMBOLS, SAMPLES_PER_SYMBOL > correlator;
-    Synchronizer < M17_SYNCWORD_SYMBOLS, SAMPLES_PER_SYMBOL > streamSync{{ -3, -3, -3, -3, +3, +3, -3, +3 }};
+    Synchronizer < M17_SYNCWORD_SYMBOLS, SAMPLES_PER_SYMBOL > streamSync{syncSymbols_t(syncSymbols[0])};
+    Synchronizer < M17_SYNCWORD_SYMBOLS, SAMPLES_PER_SYMBOL > packetSync{syncSymbols_t(syncSymbols[1])};
+    #ifdef CONFIG_M17_FIXED_POINT
+    IirFixed     < 3 >                                        sampleFilter{sfNum, sfDen};
+    #else
     Iir          < 3 >                                        sampleFilter{sfNum, sfDen};
+    #endif
+
+    // Baseband RRC filter, one instance per demodulator
+    static constexpr size_t RRC_TAPS = std::tuple_size< decltype(rrc_taps_24k) >::value;
+    #ifdef CONFIG_M17_FIXED_POINT
+    FirFixed     < RRC_TAPS >                                 rrc{rrc_taps_24k};
+    #else
+    Fir          < RRC_TAPS >                                 rrc{rrc_taps_24k};
+    #endif
 };
 
 } /* M17 */
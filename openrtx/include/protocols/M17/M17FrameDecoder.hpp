@@ -31,6 +31,7 @@
 #include "M17LinkSetupFrame.hpp"
 #include "M17Viterbi.hpp"
 #include "M17StreamFrame.hpp"
+#include "M17Datatypes.hpp"
 
 namespace M17
 {
@@ -75,6 +76,15 @@ public:
      */
     M17FrameType decodeFrame(const frame_t& frame);
 
+    /**
+     * Decode an M17 frame given as soft bits, identifying its type. Frame data
+     * must contain the sync word in the first sixteen bits.
+     *
+     * @param frame: array of soft bits containg frame data.
+     * @return the type of frame recognized.
+     */
+    M17FrameType decodeFrame(const softFrame_t& frame);
+
     /**
      * Get the latest Link Setup Frame decoded. Check of the validity of the
      * data contained in the LSF is left to application code.
@@ -113,34 +123,34 @@ private:
      * Decode Link Setup Frame data and update the internal LSF field with
      * the new frame data.
      *
-     * @param data: byte array containg frame data, without sync word.
+     * @param data: soft bit array containg frame data, without sync word.
      */
-    void decodeLSF(const std::array< uint8_t, 46 >& data);
+    void decodeLSF(const std::array< uint16_t, 368 >& data);
 
     /**
      * Decode stream data and update the internal LSF field with the new
      * frame data.
      *
-     * @param data: byte array containg frame data, without sync word.
+     * @param data: soft bit array containg frame data, without sync word.
      */
-    void decodeStream(const std::array< uint8_t, 46 >& data);
+    void decodeStream(const std::array< uint16_t, 368 >& data);
 
     /**
      * Decode a LICH block.
      *
      * @param segment: byte array where to store the decoded Link Setup Frame
      * segment. The last byte contains the segment number.
-     * @param lich: LICH block to be decoded.
+     * @param lich: LICH block to be decoded, as soft bits.
      * @return true when the LICH block is successfully decoded.
      */
-    bool decodeLich(std::array< uint8_t, 6 >& segment, const lich_t& lich);
+    bool decodeLich(std::array< uint8_t, 6 >& segment, const softLich_t& lich);
 
 
     uint8_t           lsfSegmentMap;    ///< Bitmap for LSF reassembly from LICH
     M17LinkSetupFrame lsf;              ///< Latest LSF received.
     M17LinkSetupFrame lsfFromLich;      ///< LSF assembled from LICH segments.
     M17StreamFrame    streamFrame;      ///< Latest stream dat frame received.
-    M17HardViterbi    viterbi;          ///< Viterbi decoder.
+    M17SoftViterbi    viterbi;          ///< Viterbi decoder.
 
     ///< Maximum allowed hamming distance when determining the frame type.
     static constexpr uint8_t MAX_SYNC_HAMM_DISTANCE = 4;
@@ -28,6 +28,7 @@
 #endif
 
 #include <cstdint>
+#include <array>
 
 namespace M17
 {
@@ -52,6 +53,16 @@ uint16_t calcChecksum(const uint16_t& value);
  */
 uint32_t detectErrors(const uint32_t& codeword);
 
+/**
+ * Soft-decision decoding of a Golay(24,12) codeword, using the Chase algorithm
+ * to exploit the reliability of the received bits.
+ *
+ * @param bits: 24 soft bits, most significant bit of the codeword first. Each
+ * bit ranges from 0x0000 (certainly zero) to 0xFFFF (certainly one).
+ * @return corrected codeword, or 0xFFFFFFFF if no valid codeword was found.
+ */
+uint32_t softDecode(const uint16_t *bits);
+
 }   // namespace Golay24
 
 
@@ -90,6 +101,23 @@ static inline uint16_t golay24_decode(const uint32_t& codeword)
     return ((codeword ^ errors) >> 12) & 0x0FFF;
 }
 
+
+/**
+ * Decode a Golay(24,12) codeword from its soft bits, correcting eventual bit
+ * errors. In case the bit errors are not correctable, the function returns
+ * 0xFFFF, a value outside the range allowed for the 12-bit input data required
+ * by Golay coding.
+ *
+ * \param bits: input soft bits, most significant bit first.
+ * \return original data block or 0xFFFF in case of unrecoverable errors.
+ */
+static inline uint16_t golay24_softDecode(const std::array< uint16_t, 24 >& bits)
+{
+    uint32_t codeword = Golay24::softDecode(bits.data());
+    if(codeword == 0xFFFFFFFF) return 0xFFFF;
+    return (codeword >> 12) & 0x0FFF;
+}
+
 }      // namespace M17
 
 #endif // M17_GOLAY_H
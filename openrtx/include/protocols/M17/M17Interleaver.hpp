@@ -27,33 +27,115 @@
 #error This header is C++ only!
 #endif
 
+#include "M17Decorrelator.hpp"
 #include "M17Utils.hpp"
 
 namespace M17
 {
 
 /**
- * Interleave a block of data using the quadratic permutation polynomial from
- * M17 protocol specification. Polynomial used is P(x) = 45*x + 92*x^2.
- *
- * \param data: input byte array.
+ * Permutation tables of the quadratic permutation polynomial from M17 protocol
+ * specification, P(x) = 45*x + 92*x^2 mod NB, generated at compile time.
+ * Entries of the forward table give the position P(i) of the i-th input bit in
+ * the interleaved block, entries of the inverse table give the input bit ending
+ * up in position i of the interleaved block. Bit 15 of each entry is set when
+ * the bit at the interleaved position is inverted by the decorrelator sequence,
+ * allowing to fuse the two operations in a single pass over the frame.
  */
-template < size_t N >
-void interleave(std::array< uint8_t, N >& data)
+template < size_t NB >
+struct InterleaverTable
+{
+    static constexpr uint16_t FLIP = 0x8000;
+    static constexpr uint16_t MASK = 0x7FFF;
+
+    uint16_t fwd[NB];
+    uint16_t inv[NB];
+};
+
+template < size_t NB >
+constexpr InterleaverTable< NB > makeInterleaverTable()
 {
-    std::array< uint8_t, N > interleaved;
+    static_assert(NB < InterleaverTable< NB >::FLIP, "Block size too big");
 
-    static constexpr size_t F1 = 45;
-    static constexpr size_t F2 = 92;
-    static constexpr size_t NB = N*8;
+    constexpr size_t F1 = 45;
+    constexpr size_t F2 = 92;
+    InterleaverTable< NB > table{};
 
     for(size_t i = 0; i < NB; i++)
     {
         size_t index = ((F1 * i) + (F2 * i * i)) % NB;
-        setBit(interleaved, index, getBit(data, i));
+        bool   flip  = false;
+
+        if((index / 8) < sequence.size())
+            flip = ((sequence[index / 8] >> (7 - (index % 8))) & 0x01) != 0;
+
+        table.fwd[i]     = static_cast< uint16_t >(index);
+        table.inv[index] = static_cast< uint16_t >(i);
+
+        if(flip)
+        {
+            table.fwd[i]     |= InterleaverTable< NB >::FLIP;
+            table.inv[index] |= InterleaverTable< NB >::FLIP;
+        }
     }
 
-    std::copy(interleaved.begin(), interleaved.end(), data.begin());
+    return table;
+}
+
+template < size_t NB >
+struct InterleaverLut
+{
+    static constexpr InterleaverTable< NB > table = makeInterleaverTable< NB >();
+};
+
+template < size_t NB >
+constexpr InterleaverTable< NB > InterleaverLut< NB >::table;
+
+/**
+ * Bit gathering kernel: assemble each output byte from eight input bits
+ * selected through the permutation table and optionally XOR the result with
+ * the decorrelator sequence.
+ *
+ * \param data: input byte array, overwritten with the permuted data.
+ * \param perm: permutation table, output bit i is taken from input bit perm[i].
+ * \param decorr: if true, apply the decorrelator sequence to the output.
+ */
+template < size_t N >
+inline void permuteBits(std::array< uint8_t, N >& data, const uint16_t *perm,
+                        const bool decorr)
+{
+    std::array< uint8_t, N > out;
+
+    for(size_t i = 0; i < N; i++)
+    {
+        const uint16_t *p = &perm[i * 8];
+        uint8_t byte = 0;
+
+        for(size_t j = 0; j < 8; j++)
+        {
+            uint16_t src = p[j] & InterleaverTable< N*8 >::MASK;
+            byte = (byte << 1) | ((data[src >> 3] >> (7 - (src & 0x07))) & 0x01);
+        }
+
+        if(decorr && (i < sequence.size()))
+            byte ^= sequence[i];
+
+        out[i] = byte;
+    }
+
+    std::copy(out.begin(), out.end(), data.begin());
+}
+
+/**
+ * Interleave a block of data using the quadratic permutation polynomial from
+ * M17 protocol specification. Polynomial used is P(x) = 45*x + 92*x^2.
+ *
+ * \param data: input byte array.
+ */
+template < size_t N >
+void interleave(std::array< uint8_t, N >& data)
+{
+    permuteBits(data, InterleaverLut< N*8 >::table.inv, false);
 }
 
 /**
@@ -66,16 +148,65 @@ void interleave(std::array< uint8_t, N >& data)
 template < size_t N >
 void deinterleave(std::array< uint8_t, N >& data)
 {
-    std::array< uint8_t, N > deinterleaved;
+    permuteBits(data, InterleaverLut< N*8 >::table.fwd, false);
+}
 
-    static constexpr size_t F1 = 45;
-    static constexpr size_t F2 = 92;
-    static constexpr size_t NB = N*8;
+/**
+ * Perform the deinterleaving operation on a block of soft bits previously
+ * interleaved using the quadratic permutation polynomial from M17 protocol
+ * specification. Polynomial used is P(x) = 45*x + 92*x^2.
+ *
+ * \param data: input soft bit array.
+ */
+template < size_t N >
+void deinterleave(std::array< uint16_t, N >& data)
+{
+    static constexpr auto& table = InterleaverLut< N >::table;
+    std::array< uint16_t, N > deinterleaved;
 
-    for(size_t i = 0; i < NB; i++)
+    for(size_t i = 0; i < N; i++)
     {
-        size_t index = ((F1 * i) + (F2 * i * i)) % NB;
-        setBit(deinterleaved, i, getBit(data, index));
+        uint16_t index = table.fwd[i] & InterleaverTable< N >::MASK;
+        deinterleaved[i] = data[index];
+    }
+
+    std::copy(deinterleaved.begin(), deinterleaved.end(), data.begin());
+}
+
+/**
+ * Interleave a block of data and apply the M17 decorrelation scheme to the
+ * result in a single pass. Equivalent to interleave() followed by decorrelate().
+ *
+ * \param data: input byte array.
+ */
+template < size_t N >
+void interleaveAndDecorrelate(std::array< uint8_t, N >& data)
+{
+    permuteBits(data, InterleaverLut< N*8 >::table.inv, true);
+}
+
+/**
+ * Remove the M17 decorrelation from a block of soft bits and deinterleave it
+ * in a single pass. Equivalent to decorrelate() followed by deinterleave().
+ *
+ * \param data: input soft bit array.
+ */
+template < size_t N >
+void decorrelateAndDeinterleave(std::array< uint16_t, N >& data)
+{
+    static constexpr auto& table = InterleaverLut< N >::table;
+    std::array< uint16_t, N > deinterleaved;
+
+    for(size_t i = 0; i < N; i++)
+    {
+        uint16_t entry = table.fwd[i];
+        uint16_t value = data[entry & InterleaverTable< N >::MASK];
+
+        // Inverting a soft bit is the same as computing 0xFFFF - value
+        if(entry & InterleaverTable< N >::FLIP)
+            value ^= 0xFFFF;
+
+        deinterleaved[i] = value;
     }
 
     std::copy(deinterleaved.begin(), deinterleaved.end(), data.begin());
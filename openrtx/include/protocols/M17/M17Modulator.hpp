@@ -28,6 +28,8 @@
 #include <audio_stream.h>
 #include <M17/PwmCompensator.hpp>
 #include <M17/M17Constants.hpp>
+#include <M17/M17DSP.hpp>
+#include <interpolator.hpp>
 #include <audio_path.h>
 #include <cstdint>
 #include <memory>
@@ -117,6 +119,8 @@ private:
     bool                         txRunning;        ///< Transmission running.
     bool                         invPhase;        ///< Invert signal phase
 
+    Interpolator< rrc_taps_48k.size(), M17_SAMPLES_PER_SYMBOL > rrcInterp{rrc_taps_48k};
+
     #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
     PwmCompensator pwmComp;
     #endif
@@ -0,0 +1,205 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef M17_MULTIDEMODULATOR_H
+#define M17_MULTIDEMODULATOR_H
+
+#ifndef __cplusplus
+#error This header is C++ only!
+#endif
+
+#include <M17/M17Demodulator.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <channelizer.hpp>
+#include <functional>
+#include <pthread.h>
+#include <complex>
+#include <memory>
+#include <vector>
+
+namespace M17
+{
+
+/**
+ * Multi-channel M17 receiver, demodulating all the channels of a wideband
+ * capture at once. Available only on linux.
+ *
+ * The capture is split in equally spaced channels by a polyphase channelizer,
+ * each channel is then FM demodulated, resampled to 24kHz and fed to its own
+ * M17 demodulator and frame decoder. Channel processing is spread over a pool
+ * of worker threads.
+ *
+ * Channels carrying only noise are squelched, to avoid false synchronizations
+ * of their demodulators: the median of the channel powers is taken as noise
+ * floor, so at least half of the channels are expected to be free, and only
+ * channels at least 10dB above it are demodulated.
+ */
+class M17MultiDemodulator
+{
+public:
+
+    /**
+     * Per-channel statistics.
+     */
+    struct ChannelStats
+    {
+        uint32_t frames;     ///< Total number of demodulated frames.
+        uint32_t lsf;        ///< Number of link setup frames.
+        uint32_t validLsf;   ///< Number of link setup frames with valid CRC.
+        uint32_t stream;     ///< Number of stream frames.
+        uint32_t packet;     ///< Number of packet frames.
+    };
+
+    /**
+     * Function called for each decoded frame. The function is called from the
+     * worker threads, concurrently for frames of different channels.
+     */
+    using FrameCallback = std::function< void(const size_t channel,
+                                              const M17FrameType type,
+                                              const M17FrameDecoder& decoder) >;
+
+    /**
+     * Constructor.
+     *
+     * @param sampleRate: sample rate of the capture, in Hz. The channel spacing
+     * is sampleRate / channels and each channel is sampled at twice the channel
+     * spacing, which has to be at least 24kHz.
+     * @param channels: number of channels, must be a power of two.
+     * @param workers: number of worker threads, if zero channels are processed
+     * by the thread calling process().
+     * @param callback: function called for each decoded frame, can be empty.
+     */
+    M17MultiDemodulator(const uint32_t sampleRate, const size_t channels,
+                        const size_t workers, FrameCallback callback = nullptr);
+
+    /**
+     * Destructor.
+     */
+    ~M17MultiDemodulator();
+
+    /**
+     * Process a block of samples of a complex capture. The function returns
+     * once all the channels have been processed.
+     *
+     * @param samples: complex samples.
+     * @param length: number of samples.
+     */
+    void process(const std::complex< float > *samples, const size_t length);
+
+    /**
+     * Process a block of samples of a real capture. The function returns once
+     * all the channels have been processed. Being the input real, channels at
+     * negative frequencies mirror the positive ones.
+     *
+     * @param samples: real samples.
+     * @param length: number of samples.
+     */
+    void process(const int16_t *samples, const size_t length);
+
+    /**
+     * Get the center frequency of a channel, relative to the capture center.
+     *
+     * @param channel: channel index.
+     * @return channel frequency offset, in Hz.
+     */
+    float channelFrequency(const size_t channel) const;
+
+    /**
+     * Get the statistics of a channel.
+     *
+     * @param channel: channel index.
+     * @return channel statistics.
+     */
+    ChannelStats getStats(const size_t channel) const;
+
+private:
+
+    static constexpr size_t   BLOCK_SIZE  = 960;      // Demodulator block size
+    static constexpr uint32_t RX_RATE     = 24000;    // Demodulator sample rate
+    static constexpr float    FREQ_SCALE  = 3.2f;     // Baseband units per Hz
+    static constexpr float    SQL_RATIO   = 10.0f;    // Squelch threshold, 10dB
+    static constexpr float    SQL_ALPHA   = 0.5f;     // Power smoothing factor
+
+    /**
+     * Processing state of a single channel.
+     */
+    struct Channel
+    {
+        M17Demodulator                       demod;
+        M17FrameDecoder                      decoder;
+        std::vector< std::complex< float > > input;     ///< Samples to be processed.
+        std::complex< float >                prev;      ///< Last channel sample.
+        float                                last;      ///< Last FM demodulated value.
+        float                                resPos;    ///< Resampler position.
+        size_t                               blockLen;  ///< Samples in block.
+        int16_t                              block[BLOCK_SIZE];
+        float                                energy;    ///< Energy of the pending samples.
+        float                                power;     ///< Smoothed channel power.
+        bool                                 open;      ///< Squelch open.
+        ChannelStats                         stats;
+    };
+
+    /**
+     * Worker thread function.
+     */
+    static void *workerFunc(void *arg);
+
+    /**
+     * Process the pending samples of a channel.
+     *
+     * @param index: channel index.
+     */
+    void processChannel(const size_t index);
+
+    /**
+     * Update the squelch of all the channels with the power of their pending
+     * samples.
+     */
+    void updateSquelch();
+
+    /**
+     * Process the pending samples of all the channels, spreading the work
+     * among the worker threads and waiting for its completion.
+     */
+    void dispatch();
+
+    /**
+     * Push a sample into the channelizer, queueing the channel outputs.
+     */
+    void channelize(const std::complex< float > sample);
+
+    Channelizer                              channelizer;
+    std::vector< std::unique_ptr< Channel > > chans;
+    std::vector< std::complex< float > >     chanOut;
+    FrameCallback                            callback;
+    float                                    chanRate;
+    float                                    spacing;
+
+    std::vector< pthread_t >                 workers;
+    pthread_mutex_t                          mutex;
+    pthread_cond_t                           cond;
+    uint32_t                                 generation;  ///< Work batch counter.
+    size_t                                   pending;     ///< Workers still busy.
+    bool                                     quit;
+};
+
+} /* M17 */
+
+#endif /* M17_MULTIDEMODULATOR_H */
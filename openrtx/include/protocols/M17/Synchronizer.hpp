@@ -23,6 +23,7 @@
 #define SYNCHRONIZER_H
 
 #include <cstdint>
+#include <cstdlib>
 #include <array>
 #include "Correlator.hpp"
 
@@ -41,7 +42,7 @@ public:
      * @param sync_word: symbols of the target syncword.
      */
     Synchronizer(std::array< int8_t, SYNCW_SIZE >&& sync_word) :
-        syncword(std::move(sync_word)) { }
+        syncword(std::move(sync_word)), triggered(false), sampIndex(0) { }
 
     /**
      * Destructor.
@@ -60,9 +61,26 @@ public:
      */
     int8_t update(Correlator< SYNCW_SIZE, SAMPLES_PER_SYM >& correlator,
                   const int32_t posTh, const int32_t negTh)
+    {
+        int32_t corr = correlator.convolve(syncword);
+        return update(corr, correlator.sampleIndex(), posTh, negTh);
+    }
+
+    /**
+     * Perform an update step of the syncronizer, given the convolution product
+     * between the syncword and the samples already computed by a correlator.
+     *
+     * @param corr: convolution product with the syncword.
+     * @param phase: index of the last sample within the symbol period.
+     * @param posTh: threshold to detect a positive correlation peak.
+     * @param negTh: threshold to detect a negative correlation peak.
+     * @return +1 if a positive correlation peak has been found, -1 if a negative
+     * correlation peak has been found an zero otherwise.
+     */
+    int8_t update(const int32_t corr, const size_t phase, const int32_t posTh,
+                  const int32_t negTh)
     {
         int32_t sign    = 0;
-        int32_t corr    = correlator.convolve(syncword);
         bool    trigger = (corr > posTh) || (corr < negTh);
 
         if(trigger == true)
@@ -73,7 +91,7 @@ public:
                 triggered = true;
             }
 
-            values[correlator.sampleIndex()] = corr;
+            values[phase] = corr;
         }
         else
         {
@@ -96,7 +114,7 @@ public:
                     index += 1;
                 }
 
-                if(values[index] >= 0)
+                if(peak >= 0)
                     sign = 1;
                 else
                     sign = -1;
@@ -106,6 +124,15 @@ public:
         return sign;
     }
 
+    /**
+     * Clear the syncronizer state.
+     */
+    void reset()
+    {
+        triggered = false;
+        sampIndex = 0;
+    }
+
     /**
      * Get the best sampling index equivalent to the last correlation peak
      * found. This value is meaningful only when the update() function returned
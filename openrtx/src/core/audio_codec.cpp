@@ -0,0 +1,661 @@
+/***************************************************************************
+ *   Copyright (C) 2022 - 2023 by Federico Amedeo Izzo IU2NUO,             *
+ *                                Niccolò Izzo IU2KIN                      *
+ *                                Frederik Saraci IU2NRO                   *
+ *                                Silvano Seva IU2KWO                      *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <audio_stream.h>
+#include <audio_codec.h>
+#include <pthread.h>
+#include <threads.h>
+#include <interfaces/delays.h>
+// codec2 system library has a weird include prefix
+#if defined(PLATFORM_LINUX)
+#include <codec2/codec2.h>
+#else
+#include <codec2.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <dsp.h>
+#include <ringbuf.hpp>
+
+#define BUF_SIZE        16  // Frame queue size
+#define PLAYOUT_MIN     4   // Minimum playout depth, 80ms
+#define PLAYOUT_MAX     12  // Maximum playout depth, 240ms
+#define PLC_MAX_FRAMES  4   // Maximum number of consecutive concealed frames
+#define ADAPT_FRAMES    500 // Frames without late arrivals before shrinking
+#define POLL_PERIOD     5   // Retry period of blocking push/pop, in ms
+
+// When the speaker output is mixed, two decoding operations can run at the
+// same time, for example a voice prompt over the received audio.
+#ifdef CONFIG_AUDIO_MIXER
+#define CODEC_INSTANCES 2
+#else
+#define CODEC_INSTANCES 1
+#endif
+
+/**
+ * \internal
+ * State of a codec thread. All the fields but the frame queue are modified
+ * only with init_mutex held, the queue has the codec thread on one side and
+ * the owner of the path, with init_mutex held, on the other one.
+ */
+struct codecInstance
+{
+    pathId          path;
+    bool            running;
+    bool            reqStop;
+    bool            reqDrain;
+    bool            live;
+    bool            encode;
+    pthread_t       thread;
+    pthread_attr_t  attr;
+    RingBuffer< uint64_t, BUF_SIZE > queue;
+};
+
+static uint8_t          initCnt = 0;
+static pthread_mutex_t  init_mutex    = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t  stats_mutex   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t  capture_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static struct codecInstance instances[CODEC_INSTANCES];
+static codecStats_t     stats;
+static pathId           capturePath;
+static stream_sample_t  *captureBuf = NULL;
+static uint32_t         captureFirst;
+static uint32_t         captureEnd;
+static uint32_t         captured;
+
+#ifdef PLATFORM_MOD17
+static const uint8_t micGainPre  = 4;
+static const uint8_t micGainPost = 3;
+#else
+#ifndef PLATFORM_LINUX
+static const uint8_t micGainPre  = 8;
+static const uint8_t micGainPost = 4;
+#endif
+#endif
+
+static void *encodeFunc(void *arg);
+static void *decodeFunc(void *arg);
+static bool startThread(const pathId path, const bool encode, const bool live);
+static void stopThread(struct codecInstance *inst);
+static struct codecInstance *findInstance(const pathId path);
+static void publishStats(const codecStats_t *local);
+
+
+void codec_init()
+{
+    pthread_mutex_lock(&init_mutex);
+    initCnt += 1;
+    pthread_mutex_unlock(&init_mutex);
+
+    if(initCnt > 0)
+        return;
+
+    for(size_t i = 0; i < CODEC_INSTANCES; i++)
+    {
+        instances[i].running = false;
+        instances[i].queue.reset();
+    }
+}
+
+void codec_terminate()
+{
+    pthread_mutex_lock(&init_mutex);
+    initCnt -= 1;
+
+    if(initCnt == 0)
+    {
+        for(size_t i = 0; i < CODEC_INSTANCES; i++)
+        {
+            if(instances[i].running)
+                stopThread(&instances[i]);
+        }
+    }
+
+    pthread_mutex_unlock(&init_mutex);
+}
+
+bool codec_startEncode(const pathId path)
+{
+    return startThread(path, true, false);
+}
+
+bool codec_startDecode(const pathId path, const bool live)
+{
+    return startThread(path, false, live);
+}
+
+void codec_stop(const pathId path)
+{
+    pthread_mutex_lock(&init_mutex);
+
+    struct codecInstance *inst = findInstance(path);
+    if(inst != NULL)
+        stopThread(inst);
+
+    pthread_mutex_unlock(&init_mutex);
+}
+
+bool codec_drain(const pathId path)
+{
+    pthread_mutex_lock(&init_mutex);
+
+    struct codecInstance *inst = findInstance(path);
+    if(inst != NULL)
+        inst->reqDrain = true;
+
+    pthread_mutex_unlock(&init_mutex);
+
+    return (inst != NULL);
+}
+
+bool codec_running(const pathId path)
+{
+    pthread_mutex_lock(&init_mutex);
+    bool running = (findInstance(path) != NULL);
+    pthread_mutex_unlock(&init_mutex);
+
+    return running;
+}
+
+int codec_popFrame(uint8_t *frame, const bool blocking)
+{
+    uint64_t element;
+
+    // The queue is accessed only with init_mutex held, so that the encoding
+    // operation cannot be stopped and its queue reset in the meantime. Blocking
+    // calls wait for new data with the mutex released.
+    while(true)
+    {
+        pthread_mutex_lock(&init_mutex);
+
+        struct codecInstance *inst = NULL;
+        for(size_t i = 0; i < CODEC_INSTANCES; i++)
+        {
+            if(instances[i].running && instances[i].encode)
+                inst = &instances[i];
+        }
+
+        if(inst == NULL)
+        {
+            pthread_mutex_unlock(&init_mutex);
+            return -EPERM;
+        }
+
+        bool popped = inst->queue.pop(element, false);
+        pthread_mutex_unlock(&init_mutex);
+
+        if(popped)
+            break;
+
+        // No data available and non-blocking call: just return.
+        if(blocking == false)
+            return -EAGAIN;
+
+        sleepFor(0, POLL_PERIOD);
+    }
+
+    memcpy(frame, &element, 8);
+
+    return 0;
+}
+
+int codec_pushFrame(const pathId path, const uint8_t *frame,
+                    const bool blocking)
+{
+    uint64_t element;
+    memcpy(&element, frame, 8);
+
+    // Lookup of the decoding operation and push are done with init_mutex held:
+    // a frame can never end up in the queue of an operation started by another
+    // path, nor be pushed while the queue is being reset.
+    while(true)
+    {
+        pthread_mutex_lock(&init_mutex);
+
+        struct codecInstance *inst = findInstance(path);
+        if((inst == NULL) || inst->encode)
+        {
+            pthread_mutex_unlock(&init_mutex);
+            return -EPERM;
+        }
+
+        bool pushed = inst->queue.push(element, false);
+        bool live   = inst->live;
+        pthread_mutex_unlock(&init_mutex);
+
+        if(pushed)
+            break;
+
+        // No space available and non-blocking call: return
+        if(blocking == false)
+        {
+            if(live)
+            {
+                pthread_mutex_lock(&stats_mutex);
+                stats.dropped += 1;
+                pthread_mutex_unlock(&stats_mutex);
+            }
+
+            return -EAGAIN;
+        }
+
+        sleepFor(0, POLL_PERIOD);
+    }
+
+    return 0;
+}
+
+void codec_captureFrames(const pathId path, stream_sample_t *buf,
+                         const uint32_t first, const uint32_t numFrames)
+{
+    pthread_mutex_lock(&capture_mutex);
+    capturePath  = path;
+    captureBuf   = buf;
+    captureFirst = first;
+    captureEnd   = first + numFrames;
+    captured     = 0;
+    pthread_mutex_unlock(&capture_mutex);
+}
+
+uint32_t codec_capturedFrames()
+{
+    pthread_mutex_lock(&capture_mutex);
+    uint32_t count = captured;
+    pthread_mutex_unlock(&capture_mutex);
+
+    return count;
+}
+
+void codec_getStats(codecStats_t *dest)
+{
+    pthread_mutex_lock(&stats_mutex);
+    *dest = stats;
+    pthread_mutex_unlock(&stats_mutex);
+}
+
+
+
+
+static void *encodeFunc(void *arg)
+{
+
+    streamId        iStream;
+    struct codecInstance *inst = (struct codecInstance *) arg;
+    pathId          iPath = inst->path;
+    stream_sample_t audioBuf[320];
+    struct CODEC2   *codec2;
+    filter_state_t  dcrState;
+
+    iStream = audioStream_start(iPath, audioBuf, 320, 8000,
+                                STREAM_INPUT | BUF_CIRC_DOUBLE);
+    if(iStream < 0)
+    {
+        pthread_detach(pthread_self());
+        inst->running = false;
+        return NULL;
+    }
+
+    dsp_resetFilterState(&dcrState);
+    codec2 = codec2_create(CODEC2_MODE_3200);
+
+    while(inst->reqStop == false)
+    {
+        // Invalid path, quit
+        if(audioPath_getStatus(iPath) != PATH_OPEN)
+            break;
+
+        dataBlock_t audio = inputStream_acquire(iStream);
+        if(audio.data == NULL)
+            break;
+
+        #ifndef PLATFORM_LINUX
+        // Pre-amplification stage
+        for(size_t i = 0; i < audio.len; i++) audio.data[i] *= micGainPre;
+
+        // DC removal
+        dsp_dcRemoval(&dcrState, audio.data, audio.len);
+
+        // Post-amplification stage
+        for(size_t i = 0; i < audio.len; i++) audio.data[i] *= micGainPost;
+        #endif
+
+        // CODEC2 encodes 160ms of speech into 8 bytes: here we write the
+        // new encoded data into a buffer of 16 bytes writing the first
+        // half and then the second one, sequentially.
+        // Data ready flag is rised once all the 16 bytes contain new data.
+        uint64_t frame = 0;
+        codec2_encode(codec2, ((uint8_t*) &frame), audio.data);
+        inputStream_release(iStream, audio);
+
+        // If buffer is full the frame is dropped: being this thread the
+        // producer, it cannot discard the oldest element.
+        inst->queue.push(frame, false);
+    }
+
+    audioStream_terminate(iStream);
+    codec2_destroy(codec2);
+
+    // In case thread terminates due to invalid path or stream error, detach it
+    // to ensure that its memory gets freed by the OS.
+    if(inst->reqStop == false)
+        pthread_detach(pthread_self());
+
+    inst->running = false;
+    return NULL;
+}
+
+static void *decodeFunc(void *arg)
+{
+    streamId        oStream;
+    struct codecInstance *inst = (struct codecInstance *) arg;
+    pathId          oPath = inst->path;
+    stream_sample_t audioBuf[320];
+    struct CODEC2   *codec2;
+
+    // Open output stream
+    memset(audioBuf, 0x00, 320 * sizeof(stream_sample_t));
+    oStream = audioStream_start(oPath, audioBuf, 320, 8000,
+                                STREAM_OUTPUT | BUF_CIRC_DOUBLE);
+    if(oStream < 0)
+    {
+        pthread_detach(pthread_self());
+        inst->running = false;
+        return NULL;
+    }
+
+    codec2 = codec2_create(CODEC2_MODE_3200);
+
+    // Playout buffer state: playback starts only once the queue holds enough
+    // frames to absorb the irregular frame arrival from the demodulator.
+    // Excess frame discard and loss concealment are applied only to live
+    // streams, frames coming from a local source are all played in order.
+    uint64_t     lastFrame  = 0;
+    uint8_t      lostFrames = 0;
+    uint32_t     regular    = 0;
+    bool         buffering  = true;
+    codecStats_t local;
+
+    memset(&local, 0x00, sizeof(local));
+    local.target = PLAYOUT_MIN;
+
+    // Statistics are reported for live streams only
+    if(inst->live)
+    {
+        pthread_mutex_lock(&stats_mutex);
+        stats = local;
+        pthread_mutex_unlock(&stats_mutex);
+    }
+
+    // Ensure that thread start is correctly synchronized with the output
+    // stream to avoid having the decode function writing in a memory area
+    // being read at the same time by the output stream system causing cracking
+    // noises at speaker output. Behaviour observed on both Module17 and MD-UV380
+    outputStream_sync(oStream, false);
+
+    while(inst->reqStop == false)
+    {
+        // Invalid path, quit
+        if(audioPath_getStatus(oPath) != PATH_OPEN)
+            break;
+
+        size_t depth = inst->queue.size();
+        local.depth  = depth;
+
+        // Drain requested and all the queued frames played: terminate.
+        if(inst->reqDrain && (depth == 0))
+            break;
+
+        if(buffering && ((depth >= local.target) || inst->reqDrain))
+            buffering = false;
+
+        // Frames queued well beyond the target only add latency: discard the
+        // oldest ones.
+        uint64_t frame   = 0;
+        bool     newData = false;
+        if(buffering == false)
+        {
+            while(inst->live && (inst->queue.size() > (2 * local.target)))
+            {
+                inst->queue.pop(frame, false);
+                local.early += 1;
+            }
+
+            newData = inst->queue.pop(frame, false);
+        }
+
+        dataBlock_t block = outputStream_acquire(oStream);
+        if(block.data == NULL)
+            break;
+
+        stream_sample_t *audioBuf = block.data;
+
+        if(newData)
+        {
+            // Frame arrived after one or more concealed slots: increase the
+            // playout depth to better absorb the arrival jitter.
+            if(lostFrames > 0)
+            {
+                local.late += 1;
+                regular     = 0;
+                if(local.target < PLAYOUT_MAX)
+                    local.target += 1;
+            }
+
+            // Long run of regular arrivals: slowly reduce the playout latency.
+            regular += 1;
+            if((regular >= ADAPT_FRAMES) && (local.target > PLAYOUT_MIN))
+            {
+                local.target -= 1;
+                regular       = 0;
+            }
+
+            codec2_decode(codec2, audioBuf, ((uint8_t *) &frame));
+            lastFrame    = frame;
+            lostFrames   = 0;
+            local.played += 1;
+        }
+        else if(inst->live && (buffering == false) && (inst->reqDrain == false)
+                && (lostFrames < PLC_MAX_FRAMES))
+        {
+            // Missing frame: conceal it by decoding again the last one, halving
+            // the output level at each consecutive loss.
+            lostFrames += 1;
+            codec2_decode(codec2, audioBuf, ((uint8_t *) &lastFrame));
+            for(size_t i = 0; i < 160; i++) audioBuf[i] >>= lostFrames;
+            local.concealed += 1;
+        }
+        else
+        {
+            // Loss too long to be concealed, restart buffering.
+            memset(audioBuf, 0x00, 160 * sizeof(stream_sample_t));
+            buffering  = true;
+            lostFrames = 0;
+        }
+
+        if(inst->live)
+            publishStats(&local);
+
+        #ifdef PLATFORM_MD3x0
+        // Bump up volume a little bit, as on MD3x0 is quite low
+        for(size_t i = 0; i < 160; i++) audioBuf[i] *= 2;
+        #endif
+
+        // Copy the decoded frame if falling in the range to be captured
+        if(newData)
+        {
+            uint32_t num = local.played - 1;
+
+            pthread_mutex_lock(&capture_mutex);
+            if((captureBuf != NULL) && (capturePath == oPath) &&
+               (num >= captureFirst) && (num < captureEnd))
+            {
+                stream_sample_t *dest = &captureBuf[(num - captureFirst) * 160];
+                memcpy(dest, audioBuf, 160 * sizeof(stream_sample_t));
+                captured += 1;
+            }
+            pthread_mutex_unlock(&capture_mutex);
+        }
+
+        outputStream_release(oStream, block);
+    }
+
+    // Stop stream and wait until its effective termination
+    audioStream_stop(oStream);
+    codec2_destroy(codec2);
+
+    // In case thread terminates due to invalid path or stream error, detach it
+    // to ensure that its memory gets freed by the OS.
+    if(inst->reqStop == false)
+        pthread_detach(pthread_self());
+
+    inst->running = false;
+    return NULL;
+}
+
+static bool startThread(const pathId path, const bool encode, const bool live)
+{
+    // Bad incoming path
+    if(audioPath_getStatus(path) != PATH_OPEN)
+        return false;
+
+    // Handle access contention when starting the codec thread to ensure that
+    // only one call at a time can effectively start the thread.
+    pthread_mutex_lock(&init_mutex);
+
+    // Same path as before, path open, codec already running: all good.
+    struct codecInstance *inst = findInstance(path);
+    if(inst != NULL)
+    {
+        inst->reqDrain = false;
+        pthread_mutex_unlock(&init_mutex);
+        return true;
+    }
+
+    // Look for a free instance. If there is none, the new path takes over the
+    // one with the lowest priority, provided that it is closed/suspended or
+    // its priority is lower than the new one.
+    pathInfo_t newPath = audioPath_getInfo(path);
+    uint8_t    minPrio = newPath.prio;
+    for(size_t i = 0; i < CODEC_INSTANCES; i++)
+    {
+        if(instances[i].running == false)
+        {
+            inst = &instances[i];
+            break;
+        }
+
+        pathInfo_t curPath = audioPath_getInfo(instances[i].path);
+        if(curPath.status != PATH_OPEN)
+        {
+            inst    = &instances[i];
+            minPrio = 0;
+        }
+        else if(curPath.prio < minPrio)
+        {
+            inst    = &instances[i];
+            minPrio = curPath.prio;
+        }
+    }
+
+    if(inst == NULL)
+    {
+        pthread_mutex_unlock(&init_mutex);
+        return false;
+    }
+
+    if(inst->running)
+        stopThread(inst);
+
+    // The queue is reset and the instance assigned to the new path before
+    // making it visible as running: frames can be accepted only afterwards.
+    inst->queue.reset();
+    inst->path     = path;
+    inst->reqStop  = false;
+    inst->reqDrain = false;
+    inst->live     = live;
+    inst->encode   = encode;
+    inst->running  = true;
+
+    pthread_attr_init(&inst->attr);
+
+    #if defined(_MIOSIX)
+    // Set stack size of CODEC2 thread to 16kB.
+    pthread_attr_setstacksize(&inst->attr, CODEC2_TASK_STKSIZE);
+
+    // Set priority of CODEC2 thread to the maximum one, the same of RTX thread.
+    struct sched_param param;
+    param.sched_priority = sched_get_priority_max(0);
+    pthread_attr_setschedparam(&inst->attr, &param);
+    #elif defined(__ZEPHYR__)
+    // Allocate and set the stack for CODEC2 thread
+    void *codec_thread_stack = malloc(CODEC2_TASK_STKSIZE * sizeof(uint8_t));
+    pthread_attr_setstack(&inst->attr, codec_thread_stack, CODEC2_TASK_STKSIZE);
+    #endif
+
+    // Start thread
+    void *(*func)(void *) = encode ? encodeFunc : decodeFunc;
+    int ret = pthread_create(&inst->thread, &inst->attr, func, inst);
+    if(ret != 0)
+        inst->running = false;
+
+    bool running = inst->running;
+    pthread_mutex_unlock(&init_mutex);
+
+    return running;
+}
+
+static void stopThread(struct codecInstance *inst)
+{
+    inst->reqStop = true;
+    pthread_join(inst->thread, NULL);
+    inst->running = false;
+
+    #ifdef __ZEPHYR__
+    void  *addr;
+    size_t size;
+
+    pthread_attr_getstack(&inst->attr, &addr, &size);
+    free(addr);
+    #endif
+}
+
+static struct codecInstance *findInstance(const pathId path)
+{
+    for(size_t i = 0; i < CODEC_INSTANCES; i++)
+    {
+        if(instances[i].running && (instances[i].path == path))
+            return &instances[i];
+    }
+
+    return NULL;
+}
+
+static void publishStats(const codecStats_t *local)
+{
+    // Dropped frames are counted by the producer, keep its value.
+    pthread_mutex_lock(&stats_mutex);
+    uint32_t dropped = stats.dropped;
+    stats         = *local;
+    stats.dropped = dropped;
+    pthread_mutex_unlock(&stats_mutex);
+}
@@ -0,0 +1,446 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <audio_mixer.h>
+#include <pthread.h>
+#include <threads.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#define MIXER_BLOCK_SIZE 160    // Size of a mixing block, in samples
+#define MIXER_DUCK_SHIFT 2      // Attenuation of ducked inputs, 12dB
+
+struct mixerInput
+{
+    struct streamCtx *ctx;       // Context of the input stream, NULL if free
+    size_t            pos;       // Current read position
+    uint32_t          events;    // Number of syncpoints reached
+    uint8_t           gain;      // Input gain
+    uint8_t           priority;  // Input priority
+    bool              stopReq;   // Stop the input at next syncpoint
+};
+
+static pthread_mutex_t   mixMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t    mixCond  = PTHREAD_COND_INITIALIZER;
+static pthread_t         mixThread;
+static bool              threadCreated = false;
+static bool              outRunning    = false;
+
+static struct mixerInput         inputs[MIXER_MAX_INPUTS];
+static const struct audioDevice *outDevice = NULL;
+static uint32_t                  outRate   = 0;
+static struct streamCtx          outCtx;
+static stream_sample_t           outBuf[2 * MIXER_BLOCK_SIZE];
+static int32_t                   mixBuf[MIXER_BLOCK_SIZE];
+
+
+/**
+ * \internal
+ * Get the number of active mixer inputs, to be called with the mixer mutex
+ * locked.
+ */
+static uint8_t activeInputs()
+{
+    uint8_t count = 0;
+
+    for(size_t i = 0; i < MIXER_MAX_INPUTS; i++)
+    {
+        if(inputs[i].ctx != NULL)
+            count++;
+    }
+
+    return count;
+}
+
+/**
+ * \internal
+ * Detach an input from the mixer and mark its stream as stopped, to be called
+ * with the mixer mutex locked.
+ */
+static void releaseInput(struct mixerInput *in)
+{
+    in->ctx->running = 0;
+    in->ctx->priv    = NULL;
+    in->ctx          = NULL;
+}
+
+/**
+ * \internal
+ * Signal that an input reached a syncpoint, stopping it if requested.
+ */
+static void syncpoint(struct mixerInput *in)
+{
+    in->events += 1;
+
+    if(in->stopReq)
+        releaseInput(in);
+}
+
+/**
+ * \internal
+ * Sum a block of samples from each active input into the mixing buffer, to be
+ * called with the mixer mutex locked.
+ *
+ * @param size: block size.
+ */
+static void mixBlock(const size_t size)
+{
+    uint8_t maxPrio = 0;
+
+    for(size_t i = 0; i < MIXER_MAX_INPUTS; i++)
+    {
+        if((inputs[i].ctx != NULL) && (inputs[i].priority > maxPrio))
+            maxPrio = inputs[i].priority;
+    }
+
+    memset(mixBuf, 0x00, size * sizeof(int32_t));
+
+    for(size_t i = 0; i < MIXER_MAX_INPUTS; i++)
+    {
+        struct mixerInput *in = &inputs[i];
+        if(in->ctx == NULL)
+            continue;
+
+        int32_t gain = in->gain;
+        if(in->priority < maxPrio)
+            gain >>= MIXER_DUCK_SHIFT;
+
+        const stream_sample_t *samples = in->ctx->buffer;
+        const size_t bufSize = in->ctx->bufSize;
+        size_t count = 0;
+
+        if(in->ctx->bufMode == BUF_LINEAR)
+        {
+            while((count < size) && (in->pos < bufSize))
+            {
+                mixBuf[count] += (samples[in->pos] * gain) / MIXER_GAIN_UNITY;
+                count   += 1;
+                in->pos += 1;
+            }
+
+            // End of buffer reached, the stream is over
+            if(in->pos >= bufSize)
+            {
+                in->stopReq = true;
+                syncpoint(in);
+            }
+        }
+        else
+        {
+            const size_t half = bufSize / 2;
+
+            while(count < size)
+            {
+                mixBuf[count] += (samples[in->pos] * gain) / MIXER_GAIN_UNITY;
+                count   += 1;
+                in->pos += 1;
+
+                if(in->pos >= bufSize)
+                    in->pos = 0;
+
+                if((in->pos == half) || (in->pos == 0))
+                {
+                    syncpoint(in);
+                    if(in->ctx == NULL)
+                        break;
+                }
+            }
+        }
+    }
+
+    pthread_cond_broadcast(&mixCond);
+}
+
+/**
+ * \internal
+ * Mixer thread: waits for active inputs and mixes them into the output
+ * device, stopping it when all the inputs are gone.
+ */
+static void *mixerFunc(void *arg)
+{
+    (void) arg;
+
+    while(1)
+    {
+        pthread_mutex_lock(&mixMutex);
+        while(activeInputs() == 0)
+            pthread_cond_wait(&mixCond, &mixMutex);
+
+        const struct audioDevice *dev = outDevice;
+        memset(&outCtx, 0x00, sizeof(outCtx));
+        memset(outBuf,  0x00, sizeof(outBuf));
+        outCtx.buffer     = outBuf;
+        outCtx.bufSize    = 2 * MIXER_BLOCK_SIZE;
+        outCtx.bufMode    = BUF_CIRC_DOUBLE;
+        outCtx.sampleRate = outRate;
+        outRunning        = true;
+        pthread_mutex_unlock(&mixMutex);
+
+        int ret = dev->driver->start(dev->instance, dev->config, &outCtx);
+        if(ret >= 0)
+        {
+            // Synchronise with the output stream before writing to the buffer
+            dev->driver->sync(&outCtx, 0);
+
+            while(1)
+            {
+                stream_sample_t *buf;
+                int size = dev->driver->data(&outCtx, &buf);
+                if(size <= 0)
+                    break;
+
+                if(size > MIXER_BLOCK_SIZE)
+                    size = MIXER_BLOCK_SIZE;
+
+                // When no inputs are left a block of silence is written, so
+                // that stale samples are not played while stopping the device.
+                pthread_mutex_lock(&mixMutex);
+                uint8_t active = activeInputs();
+                mixBlock(size);
+                pthread_mutex_unlock(&mixMutex);
+
+                for(int i = 0; i < size; i++)
+                {
+                    int32_t sample = mixBuf[i];
+                    if(sample > INT16_MAX) sample = INT16_MAX;
+                    if(sample < INT16_MIN) sample = INT16_MIN;
+                    buf[i] = sample;
+                }
+
+                dev->driver->sync(&outCtx, 1);
+
+                if(active == 0)
+                    break;
+            }
+
+            dev->driver->stop(&outCtx);
+            dev->driver->sync(&outCtx, 0);
+        }
+
+        // Output device stopped or failed: release any remaining input
+        pthread_mutex_lock(&mixMutex);
+        for(size_t i = 0; i < MIXER_MAX_INPUTS; i++)
+        {
+            if(inputs[i].ctx != NULL)
+                releaseInput(&inputs[i]);
+        }
+
+        outRunning = false;
+        pthread_cond_broadcast(&mixCond);
+        pthread_mutex_unlock(&mixMutex);
+    }
+
+    return NULL;
+}
+
+/**
+ * \internal
+ * Start the mixer thread, to be called with the mixer mutex locked.
+ */
+static int startThread()
+{
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    #if defined(_MIOSIX)
+    pthread_attr_setstacksize(&attr, MIXER_TASK_STKSIZE);
+
+    // Audio output has the same priority of the codec thread
+    struct sched_param param;
+    param.sched_priority = sched_get_priority_max(0);
+    pthread_attr_setschedparam(&attr, &param);
+    #elif defined(__ZEPHYR__)
+    void *stack = malloc(MIXER_TASK_STKSIZE * sizeof(uint8_t));
+    pthread_attr_setstack(&attr, stack, MIXER_TASK_STKSIZE);
+    #endif
+
+    if(pthread_create(&mixThread, &attr, mixerFunc, NULL) != 0)
+        return -ENOMEM;
+
+    threadCreated = true;
+    return 0;
+}
+
+static int mixer_start(const uint8_t instance, const void *config,
+                       struct streamCtx *ctx)
+{
+    (void) instance;
+
+    const struct mixerCfg *cfg = (const struct mixerCfg *) config;
+    if((cfg == NULL) || (ctx == NULL) || (ctx->running != 0))
+        return -EINVAL;
+
+    if((ctx->bufMode == BUF_CIRC_DOUBLE) && (ctx->bufSize < 2))
+        return -EINVAL;
+
+    pthread_mutex_lock(&mixMutex);
+
+    // Wait for the output device to be completely stopped before starting
+    // a new mix with different parameters.
+    if((activeInputs() == 0) && outRunning)
+    {
+        while(outRunning)
+            pthread_cond_wait(&mixCond, &mixMutex);
+    }
+
+    // All the inputs share the same device and sample rate
+    if(activeInputs() > 0)
+    {
+        if((cfg->device != outDevice) || (ctx->sampleRate != outRate))
+        {
+            pthread_mutex_unlock(&mixMutex);
+            return -EBUSY;
+        }
+    }
+
+    struct mixerInput *in = NULL;
+    for(size_t i = 0; i < MIXER_MAX_INPUTS; i++)
+    {
+        if(inputs[i].ctx == NULL)
+        {
+            in = &inputs[i];
+            break;
+        }
+    }
+
+    if(in == NULL)
+    {
+        pthread_mutex_unlock(&mixMutex);
+        return -EBUSY;
+    }
+
+    if(threadCreated == false)
+    {
+        int ret = startThread();
+        if(ret < 0)
+        {
+            pthread_mutex_unlock(&mixMutex);
+            return ret;
+        }
+    }
+
+    outDevice    = cfg->device;
+    outRate      = ctx->sampleRate;
+    in->ctx      = ctx;
+    in->pos      = 0;
+    in->events   = 0;
+    in->gain     = MIXER_GAIN_UNITY;
+    in->priority = cfg->priority;
+    in->stopReq  = false;
+    ctx->priv    = in;
+    ctx->running = 1;
+
+    pthread_cond_broadcast(&mixCond);
+    pthread_mutex_unlock(&mixMutex);
+
+    return 0;
+}
+
+static int mixer_data(struct streamCtx *ctx, stream_sample_t **buf)
+{
+    pthread_mutex_lock(&mixMutex);
+
+    struct mixerInput *in = (struct mixerInput *) ctx->priv;
+    if((ctx->running == 0) || (in == NULL))
+    {
+        pthread_mutex_unlock(&mixMutex);
+        return -1;
+    }
+
+    int size = ctx->bufSize;
+    *buf     = ctx->buffer;
+
+    // Idle half is the one not currently being read
+    if(ctx->bufMode == BUF_CIRC_DOUBLE)
+    {
+        size = ctx->bufSize / 2;
+        if(in->pos < (size_t) size)
+            *buf += size;
+    }
+
+    pthread_mutex_unlock(&mixMutex);
+    return size;
+}
+
+static int mixer_sync(struct streamCtx *ctx, uint8_t dirty)
+{
+    (void) dirty;
+
+    pthread_mutex_lock(&mixMutex);
+
+    struct mixerInput *in = (struct mixerInput *) ctx->priv;
+    if((ctx->running == 0) || (in == NULL))
+    {
+        pthread_mutex_unlock(&mixMutex);
+        return -1;
+    }
+
+    uint32_t events = in->events;
+    while((ctx->running != 0) && (in->events == events))
+        pthread_cond_wait(&mixCond, &mixMutex);
+
+    pthread_mutex_unlock(&mixMutex);
+    return 0;
+}
+
+static void mixer_stop(struct streamCtx *ctx)
+{
+    pthread_mutex_lock(&mixMutex);
+
+    struct mixerInput *in = (struct mixerInput *) ctx->priv;
+    if((ctx->running != 0) && (in != NULL))
+        in->stopReq = true;
+
+    pthread_mutex_unlock(&mixMutex);
+}
+
+static void mixer_terminate(struct streamCtx *ctx)
+{
+    pthread_mutex_lock(&mixMutex);
+
+    struct mixerInput *in = (struct mixerInput *) ctx->priv;
+    if((ctx->running != 0) && (in != NULL))
+        releaseInput(in);
+
+    pthread_cond_broadcast(&mixCond);
+    pthread_mutex_unlock(&mixMutex);
+}
+
+void mixer_setGain(struct streamCtx *ctx, const uint8_t gain)
+{
+    pthread_mutex_lock(&mixMutex);
+
+    struct mixerInput *in = (struct mixerInput *) ctx->priv;
+    if((ctx->running != 0) && (in != NULL))
+        in->gain = gain;
+
+    pthread_mutex_unlock(&mixMutex);
+}
+
+const struct audioDriver mixer_audio_driver =
+{
+    .start     = mixer_start,
+    .data      = mixer_data,
+    .sync      = mixer_sync,
+    .stop      = mixer_stop,
+    .terminate = mixer_terminate
+};
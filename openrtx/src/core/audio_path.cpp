@@ -22,6 +22,10 @@
 #include <map>
 #include <set>
 
+// Number of open paths for each source/sink pair, audio links are established
+// by the first path opened and torn down when the last one is closed.
+static std::map< std::pair< int8_t, int8_t >, int > linkCount;
+
 /**
  * \internal
  * Data structure representing an audio path with source, destination and
@@ -48,7 +52,10 @@ struct Path
         enum AudioSource src  = (enum AudioSource) source;
         enum AudioSink   sink = (enum AudioSink)   destination;
 
-        audio_connect(src, sink);
+        int& count = linkCount[std::make_pair(source, destination)];
+        count += 1;
+        if(count == 1)
+            audio_connect(src, sink);
     }
 
     void close() const
@@ -59,6 +66,15 @@ struct Path
         enum AudioSource src  = (enum AudioSource) source;
         enum AudioSink   sink = (enum AudioSink)   destination;
 
+        auto it = linkCount.find(std::make_pair(source, destination));
+        if(it == linkCount.end())
+            return;
+
+        it->second -= 1;
+        if(it->second > 0)
+            return;
+
+        linkCount.erase(it);
         audio_disconnect(src, sink);
     }
 
@@ -72,6 +88,13 @@ struct Path
         enum AudioSink   p1Sink   = (enum AudioSink)   destination;
         enum AudioSink   p2Sink   = (enum AudioSink)   other.destination;
 
+        #ifdef CONFIG_AUDIO_MIXER
+        // Output streams from the MCU to the speaker are mixed together
+        if((p1Source == SOURCE_MCU) && (p1Sink == SINK_SPK) &&
+           (p2Source == SOURCE_MCU) && (p2Sink == SINK_SPK))
+            return true;
+        #endif
+
         return audio_checkPathCompatibility(p1Source, p1Sink, p2Source, p2Sink);
     }
 
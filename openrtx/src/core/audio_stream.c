@@ -19,7 +19,15 @@
  ***************************************************************************/
 
 #include <audio_stream.h>
+#include <string.h>
 #include <errno.h>
+#ifdef CONFIG_AUDIO_MIXER
+#include <audio_mixer.h>
+#endif
+#ifdef CONFIG_AUDIO_NATIVE_RATE
+#include <resampler.h>
+#include <stdlib.h>
+#endif
 
 #define MAX_NUM_STREAMS 3
 #define MAX_NUM_DEVICES 3
@@ -29,10 +37,166 @@ struct streamState
     const struct audioDevice *dev;
     struct streamCtx          ctx;
     pathId                    path;
+    stream_sample_t          *lent;       // Device block lent to the user
+    stream_sample_t          *lastBlock;  // Last input block lent
+    streamStats_t             stats;
+    #ifdef CONFIG_AUDIO_MIXER
+    struct mixerCfg           mixCfg;
+    #endif
+    #ifdef CONFIG_AUDIO_NATIVE_RATE
+    struct resampler         *rs;        // Rate converter, NULL if not used
+    stream_sample_t          *userBuf;   // Sample buffer of the stream user
+    size_t                    userSize;  // Size of the user sample buffer
+    #endif
 };
 
 static struct streamState streams[MAX_NUM_STREAMS] = {0};
 
+#ifdef CONFIG_AUDIO_MIXER
+static const struct audioDevice mixerDevice =
+{
+    .driver   = &mixer_audio_driver,
+    .config   = NULL,
+    .instance = 0,
+    .endpoint = SINK_SPK
+};
+#endif
+
+
+#ifdef CONFIG_AUDIO_NATIVE_RATE
+/**
+ * \internal
+ * Setup the sample rate conversion for a stream whose sample rate differs from
+ * the native one of the audio devices. For streams in circular double buffered
+ * mode the device is fed with a separate buffer at the native sample rate,
+ * converted from/to the user one each time an half of the buffer is exchanged.
+ * Linear output streams are converted all at once when started. Linear input
+ * streams are not supported, as they would need to be converted when the
+ * acquisition ends.
+ *
+ * @param id: stream ID.
+ * @param mode: stream operation mode.
+ * @return zero on success, a negative error code otherwise.
+ */
+static int setupResampler(const streamId id, const uint8_t mode)
+{
+    struct streamState *st = &streams[id];
+    const uint32_t rate    = st->ctx.sampleRate;
+
+    st->rs = NULL;
+    if(rate == CONFIG_AUDIO_NATIVE_RATE)
+        return 0;
+
+    const bool     linear = ((mode & 0x0F) == BUF_LINEAR);
+    const uint64_t size   = (uint64_t) st->ctx.bufSize * CONFIG_AUDIO_NATIVE_RATE;
+    size_t devSize        = (size + rate - 1) / rate;
+
+    if(linear)
+    {
+        if((mode & 0xF0) != STREAM_OUTPUT)
+            return -EINVAL;
+    }
+    else
+    {
+        // Each half of the buffer has to map to an integer number of samples
+        if((size % (2 * rate)) != 0)
+            return -EINVAL;
+    }
+
+    uint8_t *mem = malloc(sizeof(struct resampler) +
+                          devSize * sizeof(stream_sample_t));
+    if(mem == NULL)
+        return -ENOMEM;
+
+    struct resampler *rs = (struct resampler *) mem;
+    int ret;
+    if((mode & 0xF0) == STREAM_OUTPUT)
+        ret = resampler_init(rs, rate, CONFIG_AUDIO_NATIVE_RATE);
+    else
+        ret = resampler_init(rs, CONFIG_AUDIO_NATIVE_RATE, rate);
+
+    if(ret < 0)
+    {
+        free(mem);
+        return ret;
+    }
+
+    stream_sample_t *devBuf = (stream_sample_t *) (mem + sizeof(struct resampler));
+    memset(devBuf, 0x00, devSize * sizeof(stream_sample_t));
+
+    // The whole content of a linear output stream is known in advance
+    if(linear)
+        devSize = resampler_process(rs, st->ctx.buffer, st->ctx.bufSize, devBuf);
+
+    st->rs             = rs;
+    st->userBuf        = st->ctx.buffer;
+    st->userSize       = st->ctx.bufSize;
+    st->ctx.buffer     = devBuf;
+    st->ctx.bufSize    = devSize;
+    st->ctx.sampleRate = CONFIG_AUDIO_NATIVE_RATE;
+
+    return 0;
+}
+
+/**
+ * \internal
+ * Get the section of the user buffer corresponding to a given half of the
+ * device buffer, for streams with sample rate conversion.
+ *
+ * @param id: stream ID.
+ * @param devBuf: pointer to the half of the device buffer.
+ * @return pointer to the corresponding half of the user buffer.
+ */
+static stream_sample_t *userHalf(const streamId id,
+                                 const stream_sample_t *devBuf)
+{
+    const struct streamState *st = &streams[id];
+
+    if(devBuf == st->ctx.buffer)
+        return st->userBuf;
+
+    return st->userBuf + (st->userSize / 2);
+}
+#endif
+
+/**
+ * \internal
+ * Get the block of the user buffer corresponding to a block of the device
+ * buffer.
+ *
+ * @param id: stream ID.
+ * @param devBuf: pointer to the device block.
+ * @return pointer to the corresponding user block.
+ */
+static inline stream_sample_t *userBlock(const streamId id,
+                                         stream_sample_t *devBuf)
+{
+    #ifdef CONFIG_AUDIO_NATIVE_RATE
+    if(streams[id].rs != NULL)
+        return userHalf(id, devBuf);
+    #else
+    (void) id;
+    #endif
+
+    return devBuf;
+}
+
+/**
+ * \internal
+ * Release a stream slot, freeing its resources.
+ *
+ * @param id: stream ID.
+ */
+static void releaseStream(const streamId id)
+{
+    streams[id].path = 0;
+    streams[id].lent = NULL;
+
+    #ifdef CONFIG_AUDIO_NATIVE_RATE
+    free(streams[id].rs);
+    streams[id].rs = NULL;
+    #endif
+}
 
 /**
  * \internal
@@ -52,7 +216,7 @@ static bool validateStream(const streamId id)
     {
         // Path has been closed or suspended: terminate the stream and free it
         streams[id].dev->driver->terminate(&(streams[id].ctx));
-        streams[id].path = 0;
+        releaseStream(id);
 
         return false;
     }
@@ -104,7 +268,7 @@ streamId audioStream_start(const pathId path, stream_sample_t * const buf,
             if(audioPath_getStatus(streams[i].path) != PATH_OPEN)
             {
                 streams[i].dev->driver->terminate(&(streams[i].ctx));
-                streams[i].path = 0;
+                releaseStream(i);
             }
         }
 
@@ -125,13 +289,45 @@ streamId audioStream_start(const pathId path, stream_sample_t * const buf,
     streams[id].ctx.bufSize    = length;
     streams[id].ctx.sampleRate = sampleRate;
 
-    int ret = dev->driver->start(dev->instance, dev->config, &streams[id].ctx);
+    const void *config = dev->config;
+    int ret;
+
+    #ifdef CONFIG_AUDIO_NATIVE_RATE
+    ret = setupResampler(id, mode);
     if(ret < 0)
     {
-        streams[id].ctx.running = 0;
         streams[id].path = 0;
         return ret;
     }
+    #endif
+
+    #ifdef CONFIG_AUDIO_MIXER
+    // Output streams towards the speaker share the device through the mixer
+    if(((mode & 0xF0) == STREAM_OUTPUT) && (endpoint == SINK_SPK))
+    {
+        streams[id].mixCfg.device   = dev;
+        streams[id].mixCfg.priority = pathInfo.prio;
+        streams[id].dev             = &mixerDevice;
+        dev                         = &mixerDevice;
+        config                      = &streams[id].mixCfg;
+    }
+    #endif
+
+    streams[id].lent      = NULL;
+    streams[id].lastBlock = NULL;
+    memset(&streams[id].stats, 0x00, sizeof(streamStats_t));
+
+    ret = dev->driver->start(dev->instance, config, &streams[id].ctx);
+    if(ret < 0)
+    {
+        streams[id].ctx.running = 0;
+        releaseStream(id);
+        return ret;
+    }
+
+    // Input blocks are lent starting from the first one being filled
+    if((mode & 0xF0) == STREAM_INPUT)
+        dev->driver->data(&streams[id].ctx, &streams[id].lastBlock);
 
     return id;
 }
@@ -146,7 +342,7 @@ void audioStream_stop(const streamId id)
 
     streams[id].dev->driver->stop(&(streams[id].ctx));
     streams[id].dev->driver->sync(&(streams[id].ctx), false);
-    streams[id].path = 0;
+    releaseStream(id);
 }
 
 void audioStream_terminate(const streamId id)
@@ -158,7 +354,15 @@ void audioStream_terminate(const streamId id)
         return;
 
     streams[id].dev->driver->terminate(&(streams[id].ctx));
-    streams[id].path = 0;
+    releaseStream(id);
+}
+
+bool audioStream_running(const streamId id)
+{
+    if(validateStream(id) == false)
+        return false;
+
+    return (streams[id].ctx.running != 0);
 }
 
 dataBlock_t inputStream_getData(streamId id)
@@ -182,9 +386,141 @@ dataBlock_t inputStream_getData(streamId id)
     }
 
     block.len = (size_t) ret;
+
+    #ifdef CONFIG_AUDIO_NATIVE_RATE
+    if(streams[id].rs != NULL)
+    {
+        stream_sample_t *data = userHalf(id, block.data);
+        block.len  = resampler_process(streams[id].rs, block.data, ret, data);
+        block.data = data;
+    }
+    #endif
+
+    return block;
+}
+
+dataBlock_t inputStream_acquire(const streamId id)
+{
+    dataBlock_t block;
+    block.data = NULL;
+    block.len  = 0;
+
+    if(validateStream(id) == false)
+        return block;
+
+    struct streamState *st = &streams[id];
+    if(st->lent != NULL)
+        return block;
+
+    // Wait for a new block, unless one has been completed in the meantime
+    stream_sample_t *buf;
+    int ret = st->dev->driver->data(&(st->ctx), &buf);
+    if((ret >= 0) && (buf == st->lastBlock))
+    {
+        ret = st->dev->driver->sync(&(st->ctx), false);
+        if(ret >= 0)
+            ret = st->dev->driver->data(&(st->ctx), &buf);
+    }
+
+    if(ret < 0)
+        return block;
+
+    st->lent          = buf;
+    st->lastBlock     = buf;
+    st->stats.blocks += 1;
+    block.data        = buf;
+    block.len         = (size_t) ret;
+
+    #ifdef CONFIG_AUDIO_NATIVE_RATE
+    if(st->rs != NULL)
+    {
+        block.data = userHalf(id, buf);
+        block.len  = resampler_process(st->rs, buf, ret, block.data);
+    }
+    #endif
+
     return block;
 }
 
+void inputStream_release(const streamId id, const dataBlock_t block)
+{
+    if((id < 0) || (id >= MAX_NUM_STREAMS))
+        return;
+
+    struct streamState *st = &streams[id];
+    if((st->lent == NULL) || (block.data != userBlock(id, st->lent)))
+        return;
+
+    // The device moved to the lent block before its release
+    stream_sample_t *buf;
+    int ret = st->dev->driver->data(&(st->ctx), &buf);
+    if((ret >= 0) && (buf != st->lent))
+        st->stats.overruns += 1;
+
+    st->lent = NULL;
+}
+
+dataBlock_t outputStream_acquire(const streamId id)
+{
+    dataBlock_t block;
+    block.data = NULL;
+    block.len  = 0;
+
+    if(validateStream(id) == false)
+        return block;
+
+    struct streamState *st = &streams[id];
+    if(st->lent != NULL)
+        return block;
+
+    stream_sample_t *buf;
+    int ret = st->dev->driver->data(&(st->ctx), &buf);
+    if(ret < 0)
+        return block;
+
+    st->lent          = buf;
+    st->stats.blocks += 1;
+    block.data        = userBlock(id, buf);
+    block.len         = (size_t) ret;
+
+    #ifdef CONFIG_AUDIO_NATIVE_RATE
+    if(st->rs != NULL)
+        block.len = st->userSize / 2;
+    #endif
+
+    return block;
+}
+
+bool outputStream_release(const streamId id, const dataBlock_t block)
+{
+    if(validateStream(id) == false)
+        return false;
+
+    struct streamState *st = &streams[id];
+    if((st->lent == NULL) || (block.data != userBlock(id, st->lent)))
+        return false;
+
+    // The device started reading the lent block before its release
+    stream_sample_t *buf;
+    int ret = st->dev->driver->data(&(st->ctx), &buf);
+    if((ret >= 0) && (buf != st->lent))
+        st->stats.underruns += 1;
+
+    st->lent = NULL;
+
+    return outputStream_sync(id, true);
+}
+
+streamStats_t audioStream_getStats(const streamId id)
+{
+    streamStats_t stats = {0, 0, 0};
+
+    if((id < 0) || (id >= MAX_NUM_STREAMS))
+        return stats;
+
+    return streams[id].stats;
+}
+
 stream_sample_t *outputStream_getIdleBuffer(const streamId id)
 {
     if(validateStream(id) == false)
@@ -195,6 +531,11 @@ stream_sample_t *outputStream_getIdleBuffer(const streamId id)
     if(ret < 0)
         return NULL;
 
+    #ifdef CONFIG_AUDIO_NATIVE_RATE
+    if(streams[id].rs != NULL)
+        return userHalf(id, buf);
+    #endif
+
     return buf;
 }
 
@@ -203,9 +544,36 @@ bool outputStream_sync(const streamId id, const bool bufChanged)
     if(validateStream(id) == false)
         return false;
 
+    #ifdef CONFIG_AUDIO_NATIVE_RATE
+    // Convert the new data to the native sample rate before the exchange
+    if((streams[id].rs != NULL) && bufChanged)
+    {
+        stream_sample_t *buf;
+        int ret = streams[id].dev->driver->data(&(streams[id].ctx), &buf);
+        if(ret > 0)
+        {
+            const size_t len = streams[id].userSize / 2;
+            resampler_process(streams[id].rs, userHalf(id, buf), len, buf);
+        }
+    }
+    #endif
+
     int ret = streams[id].dev->driver->sync(&(streams[id].ctx), bufChanged);
     if(ret < 0)
         return false;
 
     return true;
 }
+
+void outputStream_setGain(const streamId id, const uint8_t gain)
+{
+    if(validateStream(id) == false)
+        return;
+
+    #ifdef CONFIG_AUDIO_MIXER
+    if(streams[id].dev == &mixerDevice)
+        mixer_setGain(&(streams[id].ctx), gain);
+    #else
+    (void) gain;
+    #endif
+}
@@ -0,0 +1,138 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <interfaces/cps_io.h>
+#include <cps_cache.h>
+#include <string.h>
+#include <stddef.h>
+
+/*
+ * Tag of a cache slot: position of the record, outcome of its read and time
+ * of the last access, with zero marking a free slot.
+ */
+typedef struct
+{
+    uint32_t lastUse;
+    uint16_t pos;
+    int      result;
+}
+cacheTag_t;
+
+typedef int (*readFn_t)(void *record, uint16_t pos);
+
+static cacheTag_t channelTags[CPS_CACHE_CHANNELS];
+static cacheTag_t contactTags[CPS_CACHE_CONTACTS];
+static cacheTag_t bankTags[CPS_CACHE_BANKS];
+
+static channel_t  channels[CPS_CACHE_CHANNELS];
+static contact_t  contacts[CPS_CACHE_CONTACTS];
+static bankHdr_t  banks[CPS_CACHE_BANKS];
+
+static uint32_t   cacheClock = 0;
+
+
+static int readChannel(void *record, uint16_t pos)
+{
+    return cps_readChannel((channel_t *) record, pos);
+}
+
+static int readContact(void *record, uint16_t pos)
+{
+    return cps_readContact((contact_t *) record, pos);
+}
+
+static int readBankHeader(void *record, uint16_t pos)
+{
+    return cps_readBankHeader((bankHdr_t *) record, pos);
+}
+
+/**
+ * \internal
+ * Look for a record in a cache table. On a miss, the record is read from the
+ * codeplug into the least recently used slot.
+ *
+ * @param tags: tags of the cache table.
+ * @param records: records of the cache table.
+ * @param recSize: size of a record.
+ * @param numRecs: number of slots in the cache table.
+ * @param pos: position of the record inside the codeplug table.
+ * @param dest: where to copy the record.
+ * @param read: function reading a record from the codeplug.
+ * @return outcome of the codeplug read.
+ */
+static int cachedRead(cacheTag_t *tags, void *records, const size_t recSize,
+                      const size_t numRecs, const uint16_t pos, void *dest,
+                      readFn_t read)
+{
+    uint8_t *slots = (uint8_t *) records;
+    size_t   lru   = 0;
+
+    for(size_t i = 0; i < numRecs; i++)
+    {
+        if((tags[i].lastUse != 0) && (tags[i].pos == pos))
+        {
+            tags[i].lastUse = ++cacheClock;
+            if(tags[i].result == 0)
+                memcpy(dest, &slots[i * recSize], recSize);
+
+            return tags[i].result;
+        }
+
+        if(tags[i].lastUse < tags[lru].lastUse)
+            lru = i;
+    }
+
+    int result = read(&slots[lru * recSize], pos);
+
+    tags[lru].lastUse = ++cacheClock;
+    tags[lru].pos     = pos;
+    tags[lru].result  = result;
+
+    if(result == 0)
+        memcpy(dest, &slots[lru * recSize], recSize);
+
+    return result;
+}
+
+
+int cpsCache_readChannel(channel_t *channel, uint16_t pos)
+{
+    return cachedRead(channelTags, channels, sizeof(channel_t),
+                      CPS_CACHE_CHANNELS, pos, channel, readChannel);
+}
+
+int cpsCache_readContact(contact_t *contact, uint16_t pos)
+{
+    return cachedRead(contactTags, contacts, sizeof(contact_t),
+                      CPS_CACHE_CONTACTS, pos, contact, readContact);
+}
+
+int cpsCache_readBankHeader(bankHdr_t *b_header, uint16_t pos)
+{
+    return cachedRead(bankTags, banks, sizeof(bankHdr_t), CPS_CACHE_BANKS,
+                      pos, b_header, readBankHeader);
+}
+
+void cpsCache_invalidate()
+{
+    memset(channelTags, 0x00, sizeof(channelTags));
+    memset(contactTags, 0x00, sizeof(contactTags));
+    memset(bankTags,    0x00, sizeof(bankTags));
+}
@@ -67,6 +67,49 @@ void dsp_dcRemoval(filter_state_t *state, audio_sample_t *buffer, size_t length)
     }
 }
 
+void dsp_resetFilterStateFixed(filter_state_fixed_t *state)
+{
+    state->u = 0;
+    state->y = 0;
+    state->initialised = false;
+}
+
+void dsp_dcRemovalFixed(filter_state_fixed_t *state, audio_sample_t *buffer,
+                        size_t length)
+{
+    /*
+     * Same filter of dsp_dcRemoval(), with the pole coefficient in Q30 format
+     * and the output history carrying eight fractional bits.
+     */
+
+    if(length < 2) return;
+
+    static constexpr int64_t alpha = 1072668082;    // 0.999 in Q30
+    size_t pos = 0;
+
+    if(state->initialised == false)
+    {
+        state->u = buffer[0];
+        state->initialised = true;
+        pos = 1;
+    }
+
+    for(; pos < length; pos++)
+    {
+        int32_t u = buffer[pos];
+        int32_t y = ((u - state->u) * 256)
+                  + static_cast< int32_t >(((alpha * state->y) + (1 << 29)) >> 30);
+
+        state->u = u;
+        state->y = y;
+
+        y = (y + 128) >> 8;
+        if(y > INT16_MAX) y = INT16_MAX;
+        if(y < INT16_MIN) y = INT16_MIN;
+        buffer[pos] = static_cast< audio_sample_t >(y);
+    }
+}
+
 void dsp_invertPhase(audio_sample_t *buffer, uint16_t length)
 {
     for(uint16_t i = 0; i < length; i++)
@@ -149,9 +149,271 @@ static bw_t _color2bw(color_t true_color)
 #error Please define a pixel format type into hwconfig.h or meson.build
 #endif
 
+#ifdef CONFIG_GFX_DOUBLE_BUFFER
+/*
+ * Two framebuffers: the UI draws into the one pointed by framebuffer while the
+ * display driver reads the other one in background.
+ */
+static PIXEL_T __attribute__((section(".bss.fb"))) framebuffers[2][FB_SIZE];
+static PIXEL_T *framebuffer = framebuffers[0];
+#else
 static PIXEL_T __attribute__((section(".bss.fb"))) framebuffer[FB_SIZE];
+#endif
 static char text[32];
 
+/*
+ * Partial refresh bookkeeping. Drawing functions widen the [dirtyTop,
+ * dirtyBottom) band of rows touched since the last render; gfx_render() then
+ * hashes only those rows and sends to the display just the ones whose content
+ * differs from what was sent last time. Since the UI redraws whole screens,
+ * the hash comparison is what keeps unchanged rows off the bus.
+ */
+#ifdef CONFIG_PIX_FMT_RGB565
+#define ROW_BYTES (CONFIG_SCREEN_WIDTH * sizeof(PIXEL_T))
+#else
+#define ROW_BYTES (CONFIG_SCREEN_WIDTH / 8)
+#endif
+
+// Changed rows closer than this are sent in a single band
+#define BAND_MERGE_GAP 8
+
+static uint8_t  dirtyTop    = 0;
+static uint8_t  dirtyBottom = CONFIG_SCREEN_HEIGHT;
+static bool     fullRefresh = true;
+static uint32_t rowHash[CONFIG_SCREEN_HEIGHT];
+
+static inline void markDirty(uint8_t top, uint8_t bottom)
+{
+    if(top < dirtyTop)       dirtyTop    = top;
+    if(bottom > dirtyBottom) dirtyBottom = bottom;
+}
+
+static uint32_t hashRow(uint8_t row)
+{
+    // FNV-1a over the row bytes
+    const uint8_t *ptr = ((const uint8_t *) framebuffer) + (row * ROW_BYTES);
+    uint32_t hash = 2166136261u;
+
+    for(size_t i = 0; i < ROW_BYTES; i++)
+    {
+        hash ^= ptr[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+
+/**
+ * Fill the horizontal span of pixels [x0, x1) of a row. Coordinates must have
+ * already been clipped to the screen area.
+ *
+ * @param y: row of the span.
+ * @param x0: first pixel of the span.
+ * @param x1: pixel past the last one of the span.
+ * @param color: fill color.
+ */
+static void fillSpan(int16_t y, int16_t x0, int16_t x1, color_t color)
+{
+    if(x1 <= x0)
+        return;
+
+    size_t first = x0 + y * CONFIG_SCREEN_WIDTH;
+    size_t last  = x1 + y * CONFIG_SCREEN_WIDTH;
+
+#ifdef CONFIG_PIX_FMT_RGB565
+    // Blending needs the old value of each pixel, leave it to gfx_setPixel
+    if(color.alpha < 255)
+    {
+        for(int16_t x = x0; x < x1; x++)
+        {
+            point_t pos = {x, y};
+            gfx_setPixel(pos, color);
+        }
+
+        return;
+    }
+
+    rgb565_t pixel = _true2highColor(color);
+    for(size_t i = first; i < last; i++)
+        framebuffer[i] = pixel;
+#elif defined CONFIG_PIX_FMT_BW
+    // Ignore more than half transparent pixels
+    if(color.alpha < 128)
+        return;
+
+    uint8_t fill      = (_color2bw(color) == BLACK) ? 0xFF : 0x00;
+    size_t  firstCell = first / 8;
+    size_t  lastCell  = (last - 1) / 8;
+    uint8_t headMask  = (uint8_t) (0xFF << (first % 8));
+    uint8_t tailMask  = (uint8_t) (0xFF >> (7 - ((last - 1) % 8)));
+
+    if(firstCell == lastCell)
+    {
+        uint8_t mask = headMask & tailMask;
+        framebuffer[firstCell] = (framebuffer[firstCell] & ~mask) | (fill & mask);
+    }
+    else
+    {
+        framebuffer[firstCell] = (framebuffer[firstCell] & ~headMask) | (fill & headMask);
+        memset(&framebuffer[firstCell + 1], fill, lastCell - firstCell - 1);
+        framebuffer[lastCell]  = (framebuffer[lastCell] & ~tailMask) | (fill & tailMask);
+    }
+#endif
+
+    markDirty(y, y + 1);
+}
+
+#ifdef CONFIG_GFX_TEXT_CACHE
+
+/*
+ * Cache of rendered text. Each entry stores the spans of set pixels produced
+ * by a gfx_printBuffer() call, so that printing the same string again with the
+ * same font, alignment and horizontal position just fills the stored spans
+ * with the requested color. Spans are kept relative to the text start row,
+ * the same text printed on another row hits the cache as well.
+ */
+#ifndef CONFIG_GFX_TEXT_CACHE_ENTRIES
+#define CONFIG_GFX_TEXT_CACHE_ENTRIES 6
+#endif
+
+#ifndef CONFIG_GFX_TEXT_CACHE_SPANS
+#define CONFIG_GFX_TEXT_CACHE_SPANS 288
+#endif
+
+typedef struct
+{
+    int16_t dy;     // Span row, relative to the text start row
+    uint8_t x0;     // First pixel of the span
+    uint8_t x1;     // Pixel past the last one of the span
+}
+textSpan_t;
+
+typedef struct
+{
+    uint32_t   lastUse;     // Zero for empty or incomplete entries
+    point_t    size;        // Text size returned by gfx_printBuffer()
+    int16_t    startX;
+    uint8_t    font;
+    uint8_t    alignment;
+    uint16_t   numSpans;
+    char       text[32];
+    textSpan_t spans[CONFIG_GFX_TEXT_CACHE_SPANS];
+}
+textCacheEntry_t;
+
+static textCacheEntry_t textCache[CONFIG_GFX_TEXT_CACHE_ENTRIES];
+static uint32_t         textCacheClock = 0;
+static textCacheEntry_t *textRecord    = NULL;
+static int16_t          textRecordY    = 0;
+
+/**
+ * Search the text cache for a given string and, on a miss, start recording
+ * its rendering into the least recently used entry.
+ *
+ * @param start: text start point.
+ * @param font: text font.
+ * @param alignment: text alignment.
+ * @param buf: text string.
+ * @return pointer to the cache entry on a hit, NULL on a miss.
+ */
+static textCacheEntry_t *textCache_lookup(point_t start, uint8_t font,
+                                          textAlign_t alignment,
+                                          const char *buf)
+{
+    size_t len = strlen(buf);
+    if(len >= sizeof(textCache[0].text))
+        return NULL;
+
+    textCacheEntry_t *victim = &textCache[0];
+    for(size_t i = 0; i < CONFIG_GFX_TEXT_CACHE_ENTRIES; i++)
+    {
+        textCacheEntry_t *entry = &textCache[i];
+        if((entry->lastUse != 0)         &&
+           (entry->startX == start.x)    &&
+           (entry->font == font)         &&
+           (entry->alignment == alignment) &&
+           (memcmp(entry->text, buf, len + 1) == 0))
+        {
+            entry->lastUse = ++textCacheClock;
+            return entry;
+        }
+
+        if(entry->lastUse < victim->lastUse)
+            victim = entry;
+    }
+
+    victim->lastUse   = 0;
+    victim->startX    = start.x;
+    victim->font      = font;
+    victim->alignment = alignment;
+    victim->numSpans  = 0;
+    memcpy(victim->text, buf, len + 1);
+
+    textRecord  = victim;
+    textRecordY = start.y;
+
+    return NULL;
+}
+
+/**
+ * Close the recording of the text cache entry in progress, if any.
+ *
+ * @param size: text size returned by gfx_printBuffer().
+ */
+static void textCache_commit(point_t size)
+{
+    if(textRecord == NULL)
+        return;
+
+    textRecord->size    = size;
+    textRecord->lastUse = ++textCacheClock;
+    textRecord          = NULL;
+}
+
+#endif
+
+/**
+ * Clip a horizontal span of glyph pixels to the text area and fill it. As
+ * done since the first text renderer, glyphs are not drawn on the first row
+ * and column of the screen.
+ *
+ * @param y: row of the span.
+ * @param x0: first pixel of the span.
+ * @param x1: pixel past the last one of the span.
+ * @param color: fill color.
+ */
+static inline void glyphSpan(int16_t y, int16_t x0, int16_t x1, color_t color)
+{
+    if(x0 < 1) x0 = 1;
+    if(x1 > CONFIG_SCREEN_WIDTH) x1 = CONFIG_SCREEN_WIDTH;
+    if(x1 <= x0)
+        return;
+
+#ifdef CONFIG_GFX_TEXT_CACHE
+    // Spans are recorded before the vertical clipping, which depends on the row
+    if(textRecord != NULL)
+    {
+        if(textRecord->numSpans < CONFIG_GFX_TEXT_CACHE_SPANS)
+        {
+            textSpan_t *span = &textRecord->spans[textRecord->numSpans++];
+            span->dy = y - textRecordY;
+            span->x0 = x0;
+            span->x1 = x1;
+        }
+        else
+        {
+            // Text too big to be cached, the entry stays empty
+            textRecord = NULL;
+        }
+    }
+#endif
+
+    if((y <= 0) || (y >= CONFIG_SCREEN_HEIGHT))
+        return;
+
+    fillSpan(y, x0, x1, color);
+}
 
 void gfx_init()
 {
@@ -168,41 +430,126 @@ void gfx_terminate()
 
 void gfx_renderRows(uint8_t startRow, uint8_t endRow)
 {
+#ifdef CONFIG_GFX_DOUBLE_BUFFER
+    // The display may still be reading the other buffer
+    display_waitRender();
+#endif
+
     display_renderRows(startRow, endRow, framebuffer);
+
+    // Rows sent here do not need to be sent again by gfx_render()
+    if(endRow > CONFIG_SCREEN_HEIGHT)
+        endRow = CONFIG_SCREEN_HEIGHT;
+
+    for(uint8_t row = startRow; row < endRow; row++)
+        rowHash[row] = hashRow(row);
+}
+
+#ifdef CONFIG_GFX_DOUBLE_BUFFER
+/**
+ * Hand the framebuffer drawn so far over to the display and make the other one
+ * the drawing target. Before drawing resumes, the new target is brought up to
+ * date with the rows drawn since the previous swap.
+ *
+ * @param startRow: first row to be sent to the display.
+ * @param endRow: row past the last one to be sent to the display.
+ */
+static void swapBuffers(uint8_t startRow, uint8_t endRow)
+{
+    PIXEL_T *front = framebuffer;
+    PIXEL_T *back  = (front == framebuffers[0]) ? framebuffers[1]
+                                                : framebuffers[0];
+
+    // The display may still be reading the other buffer
+    display_waitRender();
+
+    size_t offset = dirtyTop * ROW_BYTES;
+    size_t size   = (dirtyBottom - dirtyTop) * ROW_BYTES;
+    memcpy(((uint8_t *) back) + offset, ((uint8_t *) front) + offset, size);
+
+    display_renderRowsAsync(startRow, endRow, front);
+    framebuffer = back;
 }
+#endif
 
 void gfx_render()
 {
-    display_render(framebuffer);
+    int16_t bandStart = -1;
+    int16_t bandEnd   = -1;
+
+    for(uint8_t row = dirtyTop; row < dirtyBottom; row++)
+    {
+        uint32_t hash = hashRow(row);
+        if((hash == rowHash[row]) && (fullRefresh == false))
+            continue;
+
+        rowHash[row] = hash;
+
+        // Asynchronous transfers send a single band spanning all the changes
+#ifndef CONFIG_GFX_DOUBLE_BUFFER
+        if((bandStart >= 0) && ((row - bandEnd) > BAND_MERGE_GAP))
+        {
+            display_renderRows(bandStart, bandEnd, framebuffer);
+            bandStart = -1;
+        }
+#endif
+
+        if(bandStart < 0)
+            bandStart = row;
+
+        bandEnd = row + 1;
+    }
+
+    if(bandStart >= 0)
+    {
+#ifdef CONFIG_GFX_DOUBLE_BUFFER
+        swapBuffers(bandStart, bandEnd);
+#else
+        display_renderRows(bandStart, bandEnd, framebuffer);
+#endif
+    }
+
+    dirtyTop    = CONFIG_SCREEN_HEIGHT;
+    dirtyBottom = 0;
+    fullRefresh = false;
+}
+
+bool gfx_renderingInProgress()
+{
+#ifdef CONFIG_GFX_DOUBLE_BUFFER
+    return display_renderingInProgress();
+#else
+    return false;
+#endif
 }
 
 void gfx_clearRows(uint8_t startRow, uint8_t endRow)
 {
-    if(endRow < startRow)
+    if(endRow > CONFIG_SCREEN_HEIGHT)
+        endRow = CONFIG_SCREEN_HEIGHT;
+
+    if(endRow <= startRow)
         return;
 
-    uint16_t start = startRow * CONFIG_SCREEN_WIDTH * sizeof(PIXEL_T);
-    uint16_t height = endRow - startRow * CONFIG_SCREEN_WIDTH * sizeof(PIXEL_T);
+    uint8_t *start = ((uint8_t *) framebuffer) + (startRow * ROW_BYTES);
+    size_t   size  = (endRow - startRow) * ROW_BYTES;
+
     // Set the specified rows to 0x00 = make the screen black
-    memset(framebuffer + start, 0x00, height);
+    memset(start, 0x00, size);
+    markDirty(startRow, endRow);
 }
 
 void gfx_clearScreen()
 {
     // Set the whole framebuffer to 0x00 = make the screen black
     memset(framebuffer, 0x00, FB_SIZE * sizeof(PIXEL_T));
+    markDirty(0, CONFIG_SCREEN_HEIGHT);
 }
 
 void gfx_fillScreen(color_t color)
 {
     for(int16_t y = 0; y < CONFIG_SCREEN_HEIGHT; y++)
-    {
-        for(int16_t x = 0; x < CONFIG_SCREEN_WIDTH; x++)
-        {
-            point_t pos = {x, y};
-            gfx_setPixel(pos, color);
-        }
-    }
+        fillSpan(y, 0, CONFIG_SCREEN_WIDTH, color);
 }
 
 inline void gfx_setPixel(point_t pos, color_t color)
@@ -211,6 +558,8 @@ inline void gfx_setPixel(point_t pos, color_t color)
         pos.x < 0 || pos.y < 0)
         return; // off the screen
 
+    markDirty(pos.y, pos.y + 1);
+
 #ifdef CONFIG_PIX_FMT_RGB565
     // Blend old pixel value and new one
     if (color.alpha < 255)
@@ -303,24 +652,32 @@ void gfx_drawRect(point_t start, uint16_t width, uint16_t height, color_t color,
 {
     if(width == 0) return;
     if(height == 0) return;
-    uint16_t x_max = start.x + width - 1;
-    uint16_t y_max = start.y + height - 1;
-    bool perimeter = 0;
+
+    // Clip once, the bottom and right edges are drawn at the screen border
+    int32_t x_max = start.x + width - 1;
+    int32_t y_max = start.y + height - 1;
     if(x_max > (CONFIG_SCREEN_WIDTH - 1)) x_max = CONFIG_SCREEN_WIDTH - 1;
     if(y_max > (CONFIG_SCREEN_HEIGHT - 1)) y_max = CONFIG_SCREEN_HEIGHT - 1;
-    for(int16_t y = start.y; y <= y_max; y++)
+
+    int16_t x_min = (start.x < 0) ? 0 : start.x;
+    int16_t y_min = (start.y < 0) ? 0 : start.y;
+    if((x_min > x_max) || (y_min > y_max))
+        return;
+
+    for(int16_t y = y_min; y <= y_max; y++)
     {
-        for(int16_t x = start.x; x <= x_max; x++)
+        // If fill is false, draw only rectangle perimeter
+        if(fill || (y == start.y) || (y == y_max))
         {
-            if(y == start.y || y == y_max || x == start.x || x == x_max) perimeter = 1;
-            else perimeter = 0;
-            // If fill is false, draw only rectangle perimeter
-            if(fill || perimeter)
-            {
-                point_t pos = {x, y};
-                gfx_setPixel(pos, color);
-            }
+            fillSpan(y, x_min, x_max + 1, color);
+            continue;
         }
+
+        if(start.x >= 0)
+            fillSpan(y, start.x, start.x + 1, color);
+
+        if(x_max != start.x)
+            fillSpan(y, x_max, x_max + 1, color);
     }
 }
 
@@ -449,6 +806,23 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
 {
     GFXfont f = fonts[size];
 
+#ifdef CONFIG_GFX_TEXT_CACHE
+    const textCacheEntry_t *cached = textCache_lookup(start, size, alignment,
+                                                      buf);
+    if(cached != NULL)
+    {
+        for(size_t i = 0; i < cached->numSpans; i++)
+        {
+            const textSpan_t *span = &cached->spans[i];
+            int16_t y = start.y + span->dy;
+            if((y > 0) && (y < CONFIG_SCREEN_HEIGHT))
+                fillSpan(y, span->x0, span->x1, color);
+        }
+
+        return cached->size;
+    }
+#endif
+
     size_t len = strlen(buf);
 
     // Compute size of the first row in pixels
@@ -503,9 +877,13 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
             start.y += f.yAdvance;
         }
 
-        // Draw bitmap
+        // Draw bitmap, one run of consecutive set pixels at a time
+        int16_t glyph_x = start.x + xo;
+        int16_t glyph_y = start.y + yo;
         for (yy = 0; yy < h; yy++)
         {
+            int16_t run = -1;
+
             for (xx = 0; xx < w; xx++)
             {
                 if (!(bit++ & 7))
@@ -515,21 +893,21 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
 
                 if (bits & 0x80)
                 {
-                    if (start.y + yo + yy < CONFIG_SCREEN_HEIGHT &&
-                        start.x + xo + xx < CONFIG_SCREEN_WIDTH &&
-                        start.y + yo + yy > 0 &&
-                        start.x + xo + xx > 0)
-                    {
-                        point_t pos;
-                        pos.x = start.x + xo + xx;
-                        pos.y = start.y + yo + yy;
-                        gfx_setPixel(pos, color);
-
-                    }
+                    if (run < 0)
+                        run = xx;
+                }
+                else if (run >= 0)
+                {
+                    glyphSpan(glyph_y + yy, glyph_x + run, glyph_x + xx,
+                              color);
+                    run = -1;
                 }
 
                 bits <<= 1;
             }
+
+            if (run >= 0)
+                glyphSpan(glyph_y + yy, glyph_x + run, glyph_x + w, color);
         }
 
         start.x += glyph.xAdvance;
@@ -538,6 +916,11 @@ point_t gfx_printBuffer(point_t start, fontSize_t size, textAlign_t alignment,
     point_t text_size = {0, 0};
     text_size.x = line_size;
     text_size.y = (saved_start_y - start.y) + line_h;
+
+#ifdef CONFIG_GFX_TEXT_CACHE
+    textCache_commit(text_size);
+#endif
+
     return text_size;
 }
 
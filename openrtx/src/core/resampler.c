@@ -0,0 +1,151 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <resampler.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#define PI 3.14159265358979323846f
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while(b != 0)
+    {
+        uint32_t t = b;
+        b = a % b;
+        a = t;
+    }
+
+    return a;
+}
+
+int resampler_init(struct resampler *rs, const uint32_t inRate,
+                   const uint32_t outRate)
+{
+    if((inRate == 0) || (outRate == 0))
+        return -EINVAL;
+
+    const uint32_t div  = gcd(inRate, outRate);
+    const uint32_t up   = outRate / div;
+    const uint32_t down = inRate  / div;
+
+    if((up > RESAMPLER_MAX_FACTOR) || (down > RESAMPLER_MAX_FACTOR))
+        return -EINVAL;
+
+    const uint32_t factor = (up > down) ? up : down;
+    const uint32_t nTaps  = RESAMPLER_ORDER * factor;
+
+    rs->up        = up;
+    rs->down      = down;
+    rs->branchLen = (nTaps + up - 1) / up;
+
+    /*
+     * Windowed-sinc lowpass filter, running at the upsampled rate with the
+     * cutoff frequency slightly below the lowest among the input and output
+     * Nyquist frequencies. Taps are scaled to have a DC gain equal to the
+     * interpolation factor, compensating the zero stuffing.
+     */
+    float proto[RESAMPLER_MAX_TAPS];
+    const float fc  = 0.45f / ((float) factor);
+    const float mid = ((float) nTaps - 1.0f) / 2.0f;
+    float sum = 0.0f;
+
+    for(uint32_t i = 0; i < nTaps; i++)
+    {
+        float x = ((float) i) - mid;
+        float h = 2.0f * fc;
+        if(x != 0.0f)
+            h = sinf(2.0f * PI * fc * x) / (PI * x);
+
+        h *= 0.54f - 0.46f * cosf((2.0f * PI * i) / ((float) nTaps - 1.0f));
+        proto[i] = h;
+        sum     += h;
+    }
+
+    // Split the filter in branches, each stored contiguously
+    for(uint32_t p = 0; p < up; p++)
+    {
+        for(uint32_t k = 0; k < rs->branchLen; k++)
+        {
+            uint32_t idx = p + (k * up);
+            float tap = 0.0f;
+            if(idx < nTaps)
+                tap = (proto[idx] * up * 32768.0f) / sum;
+
+            if(tap > 32767.0f)  tap = 32767.0f;
+            if(tap < -32768.0f) tap = -32768.0f;
+
+            rs->taps[(p * rs->branchLen) + k] = (int16_t) lroundf(tap);
+        }
+    }
+
+    resampler_reset(rs);
+
+    return 0;
+}
+
+void resampler_reset(struct resampler *rs)
+{
+    rs->phase = 0;
+    rs->pos   = 0;
+    memset(rs->hist, 0x00, sizeof(rs->hist));
+}
+
+size_t resampler_process(struct resampler *rs, const stream_sample_t *in,
+                         const size_t inLen, stream_sample_t *out)
+{
+    const uint16_t len = rs->branchLen;
+    size_t count = 0;
+
+    for(size_t i = 0; i < inLen; i++)
+    {
+        // History is stored twice to have always a contiguous window, the
+        // most recent sample being at position pos.
+        rs->pos = (rs->pos == 0) ? (len - 1) : (rs->pos - 1);
+        rs->hist[rs->pos]       = in[i];
+        rs->hist[rs->pos + len] = in[i];
+
+        const int16_t *h = &rs->hist[rs->pos];
+
+        // Compute all the output samples falling between this input sample
+        // and the next one.
+        while(rs->phase < rs->up)
+        {
+            const int16_t *t = &rs->taps[rs->phase * len];
+            int32_t acc = 0;
+
+            for(uint16_t k = 0; k < len; k++)
+                acc += h[k] * t[k];
+
+            acc = (acc + (1 << 14)) >> 15;
+            if(acc > INT16_MAX) acc = INT16_MAX;
+            if(acc < INT16_MIN) acc = INT16_MIN;
+
+            out[count] = acc;
+            count     += 1;
+            rs->phase += rs->down;
+        }
+
+        rs->phase -= rs->up;
+    }
+
+    return count;
+}
@@ -26,6 +26,8 @@
 #include <voicePrompts.h>
 #include <audio_codec.h>
 #include <audio_path.h>
+#include <audio_stream.h>
+#include <vp_pcm_cache.h>
 #include <strings.h>    // For strncasecmp
 #include <ctype.h>
 #include <state.h>
@@ -38,11 +40,17 @@
 static const uint32_t VOICE_PROMPTS_DATA_MAGIC   = 0x5056;  //'VP'
 static const uint32_t VOICE_PROMPTS_DATA_VERSION = 0x1000;  // v1000 OpenRTX
 
-#define VOICE_PROMPTS_TOC_SIZE 350
 #define CODEC2_HEADER_SIZE     7
 #define VP_SEQUENCE_BUF_SIZE   128
 #define BEEP_SEQ_BUF_SIZE      256
 
+#ifdef VP_USE_FILESYSTEM
+#ifndef VP_CACHE_SIZE
+#define VP_CACHE_SIZE          4096     // Size of the prompt data cache, in bytes
+#endif
+#define VP_CACHE_ENTRIES       16       // Maximum number of cached prompts
+#endif
+
 typedef struct
 {
     uint32_t magic;
@@ -65,6 +73,7 @@ typedef struct
     uint32_t c2DataStart;
     uint32_t c2DataIndex;                   // Index into current codec2 data
     uint32_t c2DataLength;                  // Length of codec2 data for current prompt.
+    const uint8_t *c2Data;                  // Cached codec2 data, NULL if not cached.
 }
 vpSequence_t;
 
@@ -97,7 +106,8 @@ static vpSequence_t vpCurrentSequence =
     .length       = 0,
     .c2DataStart  = 0,
     .c2DataIndex  = 0,
-    .c2DataLength = 0
+    .c2DataLength = 0,
+    .c2Data       = NULL
 };
 
 static uint32_t tableOfContents[VOICE_PROMPTS_TOC_SIZE];
@@ -112,8 +122,36 @@ static bool       delayBeepUntilTick  = false;
 static pathId     vpAudioPath;
 static long long  vpStartTime;
 
+#if VP_PCM_CACHE_ENTRIES > 0
+static bool         vpPcmMode   = false;
+static streamId     vpPcmStream = -1;
+static uint32_t     vpPcmFillEnd;           // End of the captured frames
+static uint32_t     vpPushedFrames;         // Frames sent to the codec
+#endif
+
 #ifdef VP_USE_FILESYSTEM
+typedef struct
+{
+    uint16_t prompt;    // Prompt number
+    uint16_t offset;    // Offset of prompt data inside the cache pool
+    uint16_t length;    // Length of prompt data, in bytes
+    uint32_t lastUse;   // Value of the cache clock at last access
+}
+vpCacheEntry_t;
+
 static FILE *vpFile = NULL;
+
+/*
+ * Cache of prompt data, to avoid reading the voice prompt file one codec2
+ * frame at a time. Each prompt is loaded with a single read and stored in a
+ * common pool, entries are kept sorted by their offset inside the pool and are
+ * evicted in least recently used order.
+ */
+static uint8_t        vpCachePool[VP_CACHE_SIZE];
+static vpCacheEntry_t vpCacheEntries[VP_CACHE_ENTRIES];
+static uint8_t        vpCacheCount = 0;
+static uint16_t       vpCacheUsed  = 0;
+static uint32_t       vpCacheClock = 0;
 #else
 extern unsigned char _vpdata_start;
 extern unsigned char _vpdata_end;
@@ -193,6 +231,138 @@ static void fetchCodec2Data(uint8_t *data, const size_t offset)
     #endif
 }
 
+#ifdef VP_USE_FILESYSTEM
+/**
+ * \internal
+ * Remove an entry from the prompt data cache, compacting the data pool.
+ *
+ * @param index: index of the entry to be removed.
+ */
+static void vpCache_evict(const uint8_t index)
+{
+    vpCacheEntry_t *entry = &vpCacheEntries[index];
+    uint16_t start  = entry->offset;
+    uint16_t length = entry->length;
+    uint16_t end    = start + length;
+
+    memmove(&vpCachePool[start], &vpCachePool[end], vpCacheUsed - end);
+    vpCacheUsed -= length;
+
+    for(uint8_t i = index; i < (vpCacheCount - 1); i++)
+    {
+        vpCacheEntries[i]         = vpCacheEntries[i + 1];
+        vpCacheEntries[i].offset -= length;
+    }
+
+    vpCacheCount--;
+}
+
+/**
+ * \internal
+ * Get the codec2 data of a voice prompt from the cache, loading it from the
+ * voice prompt file if not present. Only entries not accessed since the given
+ * cache clock value are allowed to be evicted to make room for the new one.
+ *
+ * @param prompt: prompt number.
+ * @param minAge: cache clock value of the most recent entry which can be evicted.
+ * @return pointer to the codec2 data or NULL if the prompt cannot be cached.
+ */
+static const uint8_t *vpCache_get(const uint16_t prompt, const uint32_t minAge)
+{
+    if((vpDataLoaded == false) || (vpFile == NULL))
+        return NULL;
+
+    vpCacheClock++;
+
+    for(uint8_t i = 0; i < vpCacheCount; i++)
+    {
+        if(vpCacheEntries[i].prompt == prompt)
+        {
+            vpCacheEntries[i].lastUse = vpCacheClock;
+            return &vpCachePool[vpCacheEntries[i].offset];
+        }
+    }
+
+    uint32_t start  = tableOfContents[prompt];
+    uint32_t length = ((tableOfContents[prompt + 1] - start) / 8) * 8;
+
+    if((length == 0) || (length > VP_CACHE_SIZE))
+        return NULL;
+
+    // Make room for the new entry, evicting the least recently used ones
+    while((vpCacheCount == VP_CACHE_ENTRIES) ||
+          ((vpCacheUsed + length) > VP_CACHE_SIZE))
+    {
+        uint8_t lru = 0;
+        for(uint8_t i = 1; i < vpCacheCount; i++)
+        {
+            if(vpCacheEntries[i].lastUse < vpCacheEntries[lru].lastUse)
+                lru = i;
+        }
+
+        if(vpCacheEntries[lru].lastUse > minAge)
+            return NULL;
+
+        vpCache_evict(lru);
+    }
+
+    size_t offset = sizeof(vpHeader_t)
+                  + sizeof(tableOfContents)
+                  + CODEC2_HEADER_SIZE
+                  + start;
+
+    uint8_t *data = &vpCachePool[vpCacheUsed];
+    fseek(vpFile, offset, SEEK_SET);
+    if(fread(data, length, 1, vpFile) != 1)
+        return NULL;
+
+    vpCacheEntry_t *entry = &vpCacheEntries[vpCacheCount];
+    entry->prompt  = prompt;
+    entry->offset  = vpCacheUsed;
+    entry->length  = length;
+    entry->lastUse = vpCacheClock;
+
+    vpCacheCount++;
+    vpCacheUsed += length;
+
+    return data;
+}
+
+/**
+ * \internal
+ * Load in the cache the data of the prompts in the current sequence, stopping
+ * when the cache is full of prompts belonging to the sequence.
+ */
+static void vpCache_prefetch()
+{
+    uint32_t minAge = vpCacheClock;
+
+    for(uint16_t i = vpCurrentSequence.pos; i < vpCurrentSequence.length; i++)
+    {
+        uint16_t prompt = vpCurrentSequence.buffer[i];
+        uint32_t length = tableOfContents[prompt + 1] - tableOfContents[prompt];
+
+        // Empty prompts are skipped, the ones too long for the cache are
+        // streamed from the file.
+        if((length < 8) || (length > VP_CACHE_SIZE))
+            continue;
+
+        if(vpCache_get(prompt, minAge) == NULL)
+            break;
+    }
+}
+
+/**
+ * \internal
+ * Empty the prompt data cache.
+ */
+static void vpCache_clear()
+{
+    vpCacheCount = 0;
+    vpCacheUsed  = 0;
+}
+#endif
+
 /**
  * \internal
  * Check validity of voice prompt header.
@@ -351,6 +521,126 @@ static bool beep_tick()
 }
 
 
+#if VP_PCM_CACHE_ENTRIES > 0
+/**
+ * \internal
+ * Check if all the prompts of the current sequence are in the PCM cache,
+ * reserving an entry for the most used one not yet cached.
+ *
+ * @return true if the sequence can be played from the PCM cache.
+ */
+static bool vpPcm_sequenceCached()
+{
+    bool cached = true;
+
+    for(uint16_t i = vpCurrentSequence.pos; i < vpCurrentSequence.length; i++)
+    {
+        uint16_t prompt = vpCurrentSequence.buffer[i];
+        uint32_t frames = (tableOfContents[prompt + 1]
+                        - tableOfContents[prompt]) / 8;
+
+        if(vpPcmCache_get(prompt, frames) == NULL)
+            cached = false;
+    }
+
+    return cached;
+}
+
+/**
+ * \internal
+ * Start filling the reserved PCM cache entry, if it belongs to the prompt being
+ * sent to the codec, by capturing the audio decoded by the codec thread.
+ *
+ * @param prompt: prompt number.
+ */
+static void vpPcm_startFill(const uint16_t prompt)
+{
+    vpPcmEntry_t *entry = vpPcmCache_reserved();
+    if((entry == NULL) || (entry->prompt != prompt))
+        return;
+
+    // Capture already in progress
+    if(vpPcmFillEnd > 0)
+        return;
+
+    uint32_t frames = vpCurrentSequence.c2DataLength / 8;
+    codec_captureFrames(vpAudioPath, entry->samples, vpPushedFrames, frames);
+    vpPcmFillEnd = vpPushedFrames + frames;
+}
+
+/**
+ * \internal
+ * Terminate the filling of the reserved PCM cache entry. The entry becomes
+ * valid only if all the frames of its prompt have been decoded, otherwise the
+ * capture is discarded.
+ */
+static void vpPcm_endFill()
+{
+    if(vpPcmCache_reserved() == NULL)
+        return;
+
+    uint32_t captured = 0;
+    if(vpPcmFillEnd > 0)
+    {
+        captured = codec_capturedFrames();
+        codec_captureFrames(vpAudioPath, NULL, 0, 0);
+    }
+
+    vpPcmCache_endFill(captured);
+    vpPcmFillEnd = 0;
+}
+
+/**
+ * \internal
+ * Play the current sequence from the PCM cache, streaming each prompt directly
+ * to the speaker output.
+ */
+static void vpPcm_tick()
+{
+    // Wait for the end of the current prompt
+    if(vpPcmStream >= 0)
+    {
+        if(audioStream_running(vpPcmStream))
+            return;
+
+        audioStream_stop(vpPcmStream);
+        vpPcmStream = -1;
+        vpCurrentSequence.pos++;
+    }
+
+    while(vpCurrentSequence.pos < vpCurrentSequence.length)
+    {
+        uint16_t prompt = vpCurrentSequence.buffer[vpCurrentSequence.pos];
+        vpPcmEntry_t *entry = vpPcmCache_find(prompt);
+
+        if(entry == NULL)
+        {
+            vpCurrentSequence.pos++;
+            continue;
+        }
+
+        // Do not start playback if audio path is closed or suspended
+        if(audioPath_getStatus(vpAudioPath) != PATH_OPEN)
+            return;
+
+        vpPcmStream = audioStream_start(vpAudioPath, entry->samples,
+                                        entry->length, 8000,
+                                        STREAM_OUTPUT | BUF_LINEAR);
+        if(vpPcmStream >= 0)
+            return;
+
+        // Output stream not available, give up with the sequence
+        vpCurrentSequence.pos = vpCurrentSequence.length;
+    }
+
+    voicePromptActive     = false;
+    vpPcmMode             = false;
+    vpCurrentSequence.pos = 0;
+    disableSpkOutput();
+}
+#endif
+
+
 void vp_init()
 {
     #ifdef VP_USE_FILESYSTEM
@@ -359,6 +649,8 @@ void vp_init()
 
     if(vpFile == NULL)
         return;
+
+    vpCache_clear();
     #else
     if(&_vpdata_start == &_vpdata_end)
         return;
@@ -399,7 +691,11 @@ void vp_terminate()
     codec_terminate();
 
     #ifdef VP_USE_FILESYSTEM
-    fclose(vpFile);
+    if(vpFile != NULL)
+        fclose(vpFile);
+
+    vpFile = NULL;
+    vpCache_clear();
     #endif
 }
 
@@ -407,12 +703,24 @@ void vp_stop()
 {
     voicePromptActive = false;
     codec_stop(vpAudioPath);
+
+    #if VP_PCM_CACHE_ENTRIES > 0
+    vpPcm_endFill();
+
+    if(vpPcmStream >= 0)
+        audioStream_terminate(vpPcmStream);
+
+    vpPcmStream = -1;
+    vpPcmMode   = false;
+    #endif
+
     disableSpkOutput();
 
     // Clear voice prompt sequence data
     vpCurrentSequence.pos          = 0;
     vpCurrentSequence.c2DataIndex  = 0;
     vpCurrentSequence.c2DataLength = 0;
+    vpCurrentSequence.c2Data       = NULL;
 
     // If any beep is playing, immediately stop it.
     beep_flush();
@@ -556,9 +864,26 @@ void vp_play()
     if (vpCurrentSequence.length <= 0)
         return;
 
+    // Sequences made only of prompts from the PCM cache are played without
+    // using the codec, starting immediately.
+    #if VP_PCM_CACHE_ENTRIES > 0
+    if(vpPcm_sequenceCached())
+    {
+        vpPcmMode         = true;
+        voicePromptActive = true;
+        enableSpkOutput();
+        return;
+    }
+    #endif
+
     // TODO: remove this once switching to hardware-based I2C driver for AT1846S
     // management.
     vpStartTime = getTick();
+
+    // Load the prompt data while waiting for the playback to start
+    #ifdef VP_USE_FILESYSTEM
+    vpCache_prefetch();
+    #endif
 }
 
 void vp_tick()
@@ -584,12 +909,24 @@ void vp_tick()
         vpStartTime       = 0;
         voicePromptActive = true;
         enableSpkOutput();
-        codec_startDecode(vpAudioPath);
+        codec_startDecode(vpAudioPath, false);
+
+        #if VP_PCM_CACHE_ENTRIES > 0
+        vpPushedFrames = 0;
+        #endif
     }
 
     if (voicePromptActive == false)
         return;
 
+    #if VP_PCM_CACHE_ENTRIES > 0
+    if(vpPcmMode)
+    {
+        vpPcm_tick();
+        return;
+    }
+    #endif
+
     while(vpCurrentSequence.pos < vpCurrentSequence.length)
     {
         // get the codec2 data for the current prompt if needed.
@@ -602,6 +939,14 @@ void vp_tick()
             vpCurrentSequence.c2DataStart  = tableOfContents[promptNumber];
             vpCurrentSequence.c2DataLength = ((tableOfContents[promptNumber + 1]
                                            - tableOfContents[promptNumber])/8 * 8);
+
+            #ifdef VP_USE_FILESYSTEM
+            vpCurrentSequence.c2Data = vpCache_get(promptNumber, UINT32_MAX);
+            #endif
+
+            #if VP_PCM_CACHE_ENTRIES > 0
+            vpPcm_startFill(promptNumber);
+            #endif
         }
 
         while (vpCurrentSequence.c2DataIndex < vpCurrentSequence.c2DataLength)
@@ -609,31 +954,48 @@ void vp_tick()
             // push the codec2 data in lots of 8 byte frames.
             uint8_t c2Frame[8] = {0};
 
-            fetchCodec2Data(c2Frame, vpCurrentSequence.c2DataStart +
-                                     vpCurrentSequence.c2DataIndex);
+            if(vpCurrentSequence.c2Data != NULL)
+                memcpy(c2Frame, vpCurrentSequence.c2Data +
+                                vpCurrentSequence.c2DataIndex, 8);
+            else
+                fetchCodec2Data(c2Frame, vpCurrentSequence.c2DataStart +
+                                         vpCurrentSequence.c2DataIndex);
 
             // Do not push codec2 data if audio path is closed or suspended
             if(audioPath_getStatus(vpAudioPath) != PATH_OPEN)
                 return;
 
-            if(codec_pushFrame(c2Frame, false) < 0)
+            if(codec_pushFrame(vpAudioPath, c2Frame, false) < 0)
                 return;
 
+            #if VP_PCM_CACHE_ENTRIES > 0
+            vpPushedFrames += 1;
+            #endif
             vpCurrentSequence.c2DataIndex += 8;
         }
 
         vpCurrentSequence.pos++;            // ready for next prompt in sequence.
         vpCurrentSequence.c2DataLength = 0; // flag that we need to get more data.
         vpCurrentSequence.c2DataIndex  = 0;
+        vpCurrentSequence.c2Data       = NULL;
     }
 
-    // see if we've finished.
+    // see if we've finished, letting the codec play the queued frames before
+    // releasing the speaker.
     if(vpCurrentSequence.pos == vpCurrentSequence.length)
     {
+        if(codec_drain(vpAudioPath))
+            return;
+
+        #if VP_PCM_CACHE_ENTRIES > 0
+        vpPcm_endFill();
+        #endif
+
         voicePromptActive              = false;
         vpCurrentSequence.pos          = 0;
         vpCurrentSequence.c2DataIndex  = 0;
         vpCurrentSequence.c2DataLength = 0;
+        vpCurrentSequence.c2Data       = NULL;
         codec_stop(vpAudioPath);
         disableSpkOutput();
     }
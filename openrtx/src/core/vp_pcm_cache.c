@@ -0,0 +1,119 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <voicePrompts.h>
+#include <vp_pcm_cache.h>
+#include <string.h>
+#include <stddef.h>
+
+#if VP_PCM_CACHE_ENTRIES > 0
+
+static vpPcmEntry_t cache[VP_PCM_CACHE_ENTRIES];
+static uint16_t     useCount[VOICE_PROMPTS_TOC_SIZE];
+static vpPcmEntry_t *reserved = NULL;   // Entry waiting to be filled
+static uint32_t     reservedFrames;     // Length of the reserved prompt
+
+
+void vpPcmCache_reset()
+{
+    for(size_t i = 0; i < VP_PCM_CACHE_ENTRIES; i++)
+        cache[i].length = 0;
+
+    memset(useCount, 0x00, sizeof(useCount));
+    reserved = NULL;
+}
+
+vpPcmEntry_t *vpPcmCache_find(const uint16_t prompt)
+{
+    for(size_t i = 0; i < VP_PCM_CACHE_ENTRIES; i++)
+    {
+        if((cache[i].length > 0) && (cache[i].prompt == prompt))
+            return &cache[i];
+    }
+
+    return NULL;
+}
+
+vpPcmEntry_t *vpPcmCache_get(const uint16_t prompt, const uint32_t frames)
+{
+    if(prompt >= VOICE_PROMPTS_TOC_SIZE)
+        return NULL;
+
+    // Usage counters saturate: halve all of them, keeping their ranking
+    if(useCount[prompt] == UINT16_MAX)
+    {
+        for(size_t i = 0; i < VOICE_PROMPTS_TOC_SIZE; i++)
+            useCount[i] /= 2;
+    }
+
+    useCount[prompt] += 1;
+
+    vpPcmEntry_t *entry = vpPcmCache_find(prompt);
+    if(entry != NULL)
+        return entry;
+
+    if((frames == 0) || ((frames * 160) > VP_PCM_CACHE_SAMPLES))
+        return NULL;
+
+    // Pick an empty entry or the one of the least used prompt
+    entry = &cache[0];
+    for(size_t i = 0; i < VP_PCM_CACHE_ENTRIES; i++)
+    {
+        if(cache[i].length == 0)
+        {
+            entry = &cache[i];
+            break;
+        }
+
+        if(useCount[cache[i].prompt] < useCount[entry->prompt])
+            entry = &cache[i];
+    }
+
+    if((entry->length > 0) && (useCount[entry->prompt] >= useCount[prompt]))
+        return NULL;
+
+    if(reserved == NULL)
+    {
+        entry->prompt  = prompt;
+        entry->length  = 0;
+        reserved       = entry;
+        reservedFrames = frames;
+    }
+
+    return NULL;
+}
+
+vpPcmEntry_t *vpPcmCache_reserved()
+{
+    return reserved;
+}
+
+void vpPcmCache_endFill(const uint32_t frames)
+{
+    if(reserved == NULL)
+        return;
+
+    if(frames >= reservedFrames)
+        reserved->length = reservedFrames * 160;
+
+    reserved = NULL;
+}
+
+#endif
@@ -23,5 +23,9 @@
 
 #ifdef CONFIG_M17
 Fir< std::tuple_size< decltype(M17::rrc_taps_48k) >::value > M17::rrc_48k(M17::rrc_taps_48k);
+#ifdef CONFIG_M17_FIXED_POINT
+FirFixed< std::tuple_size< decltype(M17::rrc_taps_24k) >::value > M17::rrc_24k(M17::rrc_taps_24k);
+#else
 Fir< std::tuple_size< decltype(M17::rrc_taps_24k) >::value > M17::rrc_24k(M17::rrc_taps_24k);
 #endif
+#endif
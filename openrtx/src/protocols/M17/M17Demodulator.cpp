@@ -129,7 +129,8 @@ static inline void pushLog(const log_entry_t& e)
      * 1) do not push data to log while dump is in progress
      * 2) if triggered, increase the counter
      * 3) fill half of the buffer with entries after the trigger, then start dump
-     * 4) if buffer is full, erase the oldest element
+     * 4) if buffer is full, erase the oldest element: safe, as the log thread
+     *    does not pop data until the dump starts
      * 5) push data without blocking
      */
 
@@ -148,7 +149,7 @@ static inline void pushLog(const log_entry_t& e)
 #endif
 
 
-M17Demodulator::M17Demodulator()
+M17Demodulator::M17Demodulator() : basebandId(-1), basebandPath(-1)
 {
 
 }
@@ -169,6 +170,8 @@ void M17Demodulator::init()
     baseband_buffer = std::make_unique< int16_t[] >(2 * SAMPLE_BUF_SIZE);
     demodFrame      = std::make_unique< frame_t >();
     readyFrame      = std::make_unique< frame_t >();
+    demodSoftFrame  = std::make_unique< softFrame_t >();
+    readySoftFrame  = std::make_unique< softFrame_t >();
 
     reset();
 
@@ -192,6 +195,8 @@ void M17Demodulator::terminate()
     baseband_buffer.reset();
     demodFrame.reset();
     readyFrame.reset();
+    demodSoftFrame.reset();
+    readySoftFrame.reset();
 
     #ifdef ENABLE_DEMOD_LOG
     logRunning = false;
@@ -222,6 +227,12 @@ const frame_t& M17Demodulator::getFrame()
     return *readyFrame;
 }
 
+const softFrame_t& M17Demodulator::getSoftFrame()
+{
+    newFrame = false;
+    return *readySoftFrame;
+}
+
 bool M17Demodulator::isLocked()
 {
     return locked;
@@ -234,157 +245,172 @@ bool M17Demodulator::update(const bool invertPhase)
         return false;
 
     // Read samples from the ADC
-    dataBlock_t baseband = inputStream_getData(basebandId);
-    if(baseband.data != NULL)
+    dataBlock_t baseband = inputStream_acquire(basebandId);
+    if(baseband.data == NULL)
+        return newFrame;
+
+    process(baseband.data, baseband.len, invertPhase);
+    inputStream_release(basebandId, baseband);
+
+    return newFrame;
+}
+
+bool M17Demodulator::process(int16_t *samples, const size_t length,
+                             const bool invertPhase)
+{
+    // Apply DC removal filter
+    #ifdef CONFIG_M17_FIXED_POINT
+    dsp_dcRemovalFixed(&dcrState, samples, length);
+    #else
+    dsp_dcRemoval(&dcrState, samples, length);
+    #endif
+
+    // Apply RRC on the whole block of samples, in place
+    const int16_t gain = invertPhase ? -1 : 1;
+    rrc.process(samples, samples, length, gain);
+
+    // Process samples
+    for(size_t i = 0; i < length; i++)
     {
-        // Apply DC removal filter
-        dsp_dcRemoval(&dcrState, baseband.data, baseband.len);
+        int16_t sample = samples[i];
+
+        // Update correlator and sample filter for correlation thresholds
+        correlator.sample(sample);
+        corrThreshold = sampleFilter(std::abs(sample));
 
-        // Process samples
-        for(size_t i = 0; i < baseband.len; i++)
+        switch(demodState)
         {
-            // Apply RRC on the baseband sample
-            float           elem   = static_cast< float >(baseband.data[i]);
-            if(invertPhase) elem   = 0.0f - elem;
-            int16_t         sample = static_cast< int16_t >(M17::rrc_24k(elem));
+            case DemodState::INIT:
+            {
+                initCount -= 1;
+                if(initCount == 0)
+                    demodState = DemodState::UNLOCKED;
+            }
+                break;
 
-            // Update correlator and sample filter for correlation thresholds
-            correlator.sample(sample);
-            corrThreshold = sampleFilter(std::abs(sample));
+            case DemodState::UNLOCKED:
+            {
+                int32_t syncThresh = static_cast< int32_t >(corrThreshold * 33);
 
-            switch(demodState)
+                if(updateSync(syncThresh))
+                    demodState = DemodState::SYNCED;
+            }
+                break;
+
+            case DemodState::SYNCED:
             {
-                case DemodState::INIT:
+                // Set sampling point and deviation, zero frame symbol count
+                samplingPoint  = syncIndex;
+                outerDeviation = correlator.maxDeviation(samplingPoint);
+                frameIndex     = 0;
+
+                // Quantize the syncword taking data from the correlator
+                // memory.
+                const int16_t *syncSamples = correlator.symbols(samplingPoint);
+                for(size_t i = 0; i < M17_SYNCWORD_SYMBOLS; i++)
+                    updateFrame(syncSamples[i]);
+
+                if(syncwordDistance() == 0)
                 {
-                    initCount -= 1;
-                    if(initCount == 0)
-                        demodState = DemodState::UNLOCKED;
+                    locked     = true;
+                    demodState = DemodState::LOCKED;
                 }
-                    break;
-
-                case DemodState::UNLOCKED:
+                else
                 {
-                    int32_t syncThresh = static_cast< int32_t >(corrThreshold * 33.0f);
-                    int8_t  syncStatus = streamSync.update(correlator, syncThresh, -syncThresh);
-
-                    if(syncStatus != 0)
-                        demodState = DemodState::SYNCED;
+                    demodState = DemodState::UNLOCKED;
                 }
-                    break;
+            }
+                break;
 
-                case DemodState::SYNCED:
+            case DemodState::LOCKED:
+            {
+                // Quantize and update frame at each sampling point
+                if(sampleIndex == samplingPoint)
                 {
-                    // Set sampling point and deviation, zero frame symbol count
-                    samplingPoint  = streamSync.samplingIndex();
-                    outerDeviation = correlator.maxDeviation(samplingPoint);
-                    frameIndex     = 0;
-
-                    // Quantize the syncword taking data from the correlator
-                    // memory.
-                    for(size_t i = 0; i < SYNCWORD_SAMPLES; i++)
-                    {
-                        size_t  pos = (correlator.index() + i) % SYNCWORD_SAMPLES;
-                        int16_t val = correlator.data()[pos];
-
-                        if((pos % SAMPLES_PER_SYMBOL) == samplingPoint)
-                            updateFrame(val);
-                    }
-
-                    uint8_t hd  = hammingDistance((*demodFrame)[0], STREAM_SYNC_WORD[0]);
-                            hd += hammingDistance((*demodFrame)[1], STREAM_SYNC_WORD[1]);
+                    updateFrame(sample);
 
-                    if(hd == 0)
+                    // When we have reached almost the end of a frame, switch
+                    // to syncpoint update.
+                    if(frameIndex == (M17_FRAME_SYMBOLS - M17_SYNCWORD_SYMBOLS/2))
                     {
-                        locked     = true;
-                        demodState = DemodState::LOCKED;
-                    }
-                    else
-                    {
-                        demodState = DemodState::UNLOCKED;
+                        demodState = DemodState::SYNC_UPDATE;
+                        syncCount  = SYNCWORD_SAMPLES * 2;
                     }
                 }
-                    break;
+            }
+                break;
+
+            case DemodState::SYNC_UPDATE:
+            {
+                // Keep filling the ongoing frame!
+                if(sampleIndex == samplingPoint)
+                    updateFrame(sample);
 
-                case DemodState::LOCKED:
+                // Find the new correlation peak
+                int32_t syncThresh = static_cast< int32_t >(corrThreshold * 33);
+
+                if(updateSync(syncThresh))
                 {
-                    // Quantize and update frame at each sampling point
-                    if(sampleIndex == samplingPoint)
+                    // Correlation has to coincide with a syncword!
+                    if(frameIndex == M17_SYNCWORD_SYMBOLS)
                     {
-                        updateFrame(sample);
-
-                        // When we have reached almost the end of a frame, switch
-                        // to syncpoint update.
-                        if(frameIndex == (M17_FRAME_SYMBOLS - M17_SYNCWORD_SYMBOLS/2))
+                        // Valid sync found: update deviation and sample
+                        // point, then go back to locked state
+                        if(syncwordDistance() <= 1)
                         {
-                            demodState = DemodState::SYNC_UPDATE;
-                            syncCount  = SYNCWORD_SAMPLES * 2;
+                            outerDeviation = correlator.maxDeviation(samplingPoint);
+                            samplingPoint  = syncIndex;
+                            missedSyncs    = 0;
+                            demodState     = DemodState::LOCKED;
+                            break;
                         }
                     }
                 }
-                    break;
 
-                case DemodState::SYNC_UPDATE:
+                // No syncword found within the window, increase the count
+                // of missed syncs and choose where to go. The lock is lost
+                // after four consecutive sync misses.
+                if(syncCount == 0)
                 {
-                    // Keep filling the ongoing frame!
-                    if(sampleIndex == samplingPoint)
-                        updateFrame(sample);
-
-                    // Find the new correlation peak
-                    int32_t syncThresh = static_cast< int32_t >(corrThreshold * 33.0f);
-                    int8_t  syncStatus = streamSync.update(correlator, syncThresh, -syncThresh);
-
-                    if(syncStatus != 0)
+                    if(missedSyncs >= 4)
                     {
-                        // Correlation has to coincide with a syncword!
-                        if(frameIndex == M17_SYNCWORD_SYMBOLS)
-                        {
-                            uint8_t hd  = hammingDistance((*demodFrame)[0], STREAM_SYNC_WORD[0]);
-                                    hd += hammingDistance((*demodFrame)[1], STREAM_SYNC_WORD[1]);
-
-                            // Valid sync found: update deviation and sample
-                            // point, then go back to locked state
-                            if(hd <= 1)
-                            {
-                                outerDeviation = correlator.maxDeviation(samplingPoint);
-                                samplingPoint  = streamSync.samplingIndex();
-                                missedSyncs    = 0;
-                                demodState     = DemodState::LOCKED;
-                                break;
-                            }
-                        }
+                        demodState = DemodState::UNLOCKED;
+                        locked     = false;
                     }
-
-                    // No syncword found within the window, increase the count
-                    // of missed syncs and choose where to go. The lock is lost
-                    // after four consecutive sync misses.
-                    if(syncCount == 0)
+                    else
                     {
-                        if(missedSyncs >= 4)
-                        {
-                            demodState = DemodState::UNLOCKED;
-                            locked     = false;
-                        }
-                        else
-                        {
-                            demodState = DemodState::LOCKED;
-                        }
-
-                        missedSyncs += 1;
+                        demodState = DemodState::LOCKED;
                     }
 
-                    syncCount -= 1;
+                    missedSyncs += 1;
                 }
-                    break;
-            }
 
-            sampleCount += 1;
-            sampleIndex  = (sampleIndex + 1) % SAMPLES_PER_SYMBOL;
+                syncCount -= 1;
+            }
+                break;
         }
+
+        sampleCount += 1;
+        sampleIndex  = (sampleIndex + 1) % SAMPLES_PER_SYMBOL;
     }
 
     return newFrame;
 }
 
+/**
+ * Convert a value in the range [0, 1] to a soft bit, clamping it if outside.
+ *
+ * @param value: likelihood of the bit being one.
+ * @return soft bit value.
+ */
+static inline uint16_t softBit(const float value)
+{
+    if(value <= 0.0f) return 0x0000;
+    if(value >= 1.0f) return 0xFFFF;
+
+    return static_cast< uint16_t >(value * 65535.0f);
+}
+
 int8_t M17Demodulator::updateFrame(stream_sample_t sample)
 {
     int8_t symbol;
@@ -407,11 +433,34 @@ int8_t M17Demodulator::updateFrame(stream_sample_t sample)
     }
 
     setSymbol(*demodFrame, frameIndex, symbol);
+
+    /*
+     * Soft bits, scaled with respect to the outer symbol deviation. The first
+     * bit of the symbol is given by the sign of the sample, the second one by
+     * its magnitude compared with the decision threshold at two thirds of the
+     * outer deviation. Both bits have the same slope, so that they are given
+     * the same weight by the decoders: each one is uncertain at its threshold
+     * and reaches certainty two thirds of the outer deviation away from it.
+     * This is done in floating point also when CONFIG_M17_FIXED_POINT is
+     * defined, as it runs once per symbol rather than once per sample.
+     */
+    float dev = static_cast< float >(outerDeviation.first);
+    if(sample < 0) dev = -static_cast< float >(outerDeviation.second);
+    if(dev < 1.0f) dev = 1.0f;
+
+    float val  = static_cast< float >(sample);
+    float bit0 = 0.5f - (0.75f * val / dev);
+    float bit1 = 0.5f + (0.75f * (std::abs(val) - (2.0f * dev / 3.0f)) / dev);
+
+    (*demodSoftFrame)[2 * frameIndex]     = softBit(bit0);
+    (*demodSoftFrame)[2 * frameIndex + 1] = softBit(bit1);
+
     frameIndex += 1;
 
     if(frameIndex >= M17_FRAME_SYMBOLS)
     {
         std::swap(readyFrame, demodFrame);
+        std::swap(readySoftFrame, demodSoftFrame);
         frameIndex = 0;
         newFrame   = true;
     }
@@ -429,9 +478,62 @@ void M17Demodulator::reset()
     demodState  = DemodState::INIT;
     initCount   = RX_SAMPLE_RATE / 50;  // 50ms of init time
 
+    #ifdef CONFIG_M17_FIXED_POINT
+    dsp_resetFilterStateFixed(&dcrState);
+    #else
     dsp_resetFilterState(&dcrState);
+    #endif
+
+    rrc.reset();
+    correlator.reset();
+    streamSync.reset();
+    packetSync.reset();
+}
+
+bool M17Demodulator::updateSync(const int32_t threshold)
+{
+    auto   corr  = correlator.convolve(syncSymbols);
+    size_t phase = correlator.sampleIndex();
+
+    int8_t streamStatus = streamSync.update(corr[0], phase, threshold, -threshold);
+    int8_t packetStatus = packetSync.update(corr[1], phase, threshold, -threshold);
+
+    if(streamStatus != 0)
+    {
+        syncIndex = streamSync.samplingIndex();
+        return true;
+    }
+
+    if(packetStatus != 0)
+    {
+        syncIndex = packetSync.samplingIndex();
+        return true;
+    }
+
+    return false;
+}
+
+uint8_t M17Demodulator::syncwordDistance()
+{
+    static constexpr std::array< syncw_t, 4 > syncwords =
+    {
+        STREAM_SYNC_WORD, LSF_SYNC_WORD, PACKET_SYNC_WORD, BERT_SYNC_WORD
+    };
+
+    uint8_t minDistance = 0xFF;
+    for(auto& sw : syncwords)
+    {
+        uint8_t hd  = hammingDistance((*demodFrame)[0], sw[0]);
+                hd += hammingDistance((*demodFrame)[1], sw[1]);
+
+        if(hd < minDistance)
+            minDistance = hd;
+    }
+
+    return minDistance;
 }
 
 
 constexpr std::array < float, 3 > M17Demodulator::sfNum;
 constexpr std::array < float, 3 > M17Demodulator::sfDen;
+constexpr std::array < M17Demodulator::syncSymbols_t, 2 > M17Demodulator::syncSymbols;
@@ -43,15 +43,28 @@ void M17FrameDecoder::reset()
 
 M17FrameType M17FrameDecoder::decodeFrame(const frame_t& frame)
 {
-    std::array< uint8_t, 2 >  syncWord;
-    std::array< uint8_t, 46 > data;
+    // Hard decoding is soft decoding with all the bits fully reliable
+    softFrame_t softFrame;
 
-    std::copy_n(frame.begin(), 2, syncWord.begin());
-    std::copy(frame.begin() + 2, frame.end(), data.begin());
+    for(size_t i = 0; i < softFrame.size(); i++)
+        softFrame[i] = getBit(frame, i) ? 0xFFFF : 0x0000;
+
+    return decodeFrame(softFrame);
+}
+
+M17FrameType M17FrameDecoder::decodeFrame(const softFrame_t& frame)
+{
+    std::array< uint8_t, 2 >    syncWord;
+    std::array< uint16_t, 368 > data;
+
+    // Syncword is used only for frame type detection, slice it
+    for(size_t i = 0; i < 16; i++)
+        setBit(syncWord, i, frame[i] > 0x7FFF);
+
+    std::copy(frame.begin() + 16, frame.end(), data.begin());
 
     // Re-correlating data is the same operation as decorrelating
-    decorrelate(data);
-    deinterleave(data);
+    decorrelateAndDeinterleave(data);
 
     auto type = getFrameType(syncWord);
 
@@ -107,7 +120,7 @@ M17FrameType M17FrameDecoder::getFrameType(const std::array< uint8_t, 2 >& syncW
     return type;
 }
 
-void M17FrameDecoder::decodeLSF(const std::array< uint8_t, 46 >& data)
+void M17FrameDecoder::decodeLSF(const std::array< uint16_t, 368 >& data)
 {
     std::array< uint8_t, sizeof(M17LinkSetupFrame) > tmp;
 
@@ -115,16 +128,20 @@ void M17FrameDecoder::decodeLSF(const std::array< uint8_t, 46 >& data)
     memcpy(&lsf.data, tmp.data(), tmp.size());
 }
 
-void M17FrameDecoder::decodeStream(const std::array< uint8_t, 46 >& data)
+void M17FrameDecoder::decodeStream(const std::array< uint16_t, 368 >& data)
 {
-    // Extract and unpack the LICH segment contained at beginning of frame
-    lich_t lich;
+    // Extract and unpack the LICH segment contained at beginning of frame,
+    // Golay decoding works on soft bits.
+    softLich_t lich;
     std::array < uint8_t, 6 > lsfSegment;
 
-    std::copy_n(data.begin(), lich.size(), lich.begin());
+    std::copy(data.begin(), data.begin() + lich.size(), lich.begin());
+
     bool decodeOk = decodeLich(lsfSegment, lich);
 
-    if(decodeOk)
+    // Valid segment numbers go from zero to five, discard the segment if the
+    // LICH has been wrongly decoded.
+    if(decodeOk && (lsfSegment[5] < 6))
     {
         // Append LICH segment
         uint8_t segmentNum  = lsfSegment[5];
@@ -146,7 +163,7 @@ void M17FrameDecoder::decodeStream(const std::array< uint8_t, 46 >& data)
     }
 
     // Extract and decode stream data
-    std::array< uint8_t, 34 > punctured;
+    std::array< uint16_t, 272 > punctured;
     std::array< uint8_t, sizeof(M17StreamFrame) > tmp;
 
     auto begin = data.begin();
@@ -158,7 +175,7 @@ void M17FrameDecoder::decodeStream(const std::array< uint8_t, 46 >& data)
 }
 
 bool M17FrameDecoder::decodeLich(std::array < uint8_t, 6 >& segment,
-                            const lich_t& lich)
+                            const softLich_t& lich)
 {
     /*
      * Extract and unpack the LICH segment contained in the frame header.
@@ -167,20 +184,19 @@ bool M17FrameDecoder::decodeLich(std::array < uint8_t, 6 >& segment,
      * is the segment number, allowing to determine the correct position of the
      * segment when reassembling the LSF.
      *
-     * NOTE: LICH data is stored in big-endian format, swap and shift after
-     * memcpy convert it to little-endian.
+     * Each block is decoded from its soft bits, most significant bit first.
      */
 
     segment.fill(0x00);
 
-    size_t   index = 0;
-    uint32_t block = 0;
+    size_t index = 0;
+    std::array< uint16_t, 24 > block;
 
     for(size_t i = 0; i < 4; i++)
     {
-        memcpy(&block, lich.data() + 3*i, 3);
-        block = __builtin_bswap32(block) >> 8;
-        uint16_t decoded = golay24_decode(block);
+        auto begin = lich.begin() + (i * block.size());
+        std::copy(begin, begin + block.size(), block.begin());
+        uint16_t decoded = golay24_softDecode(block);
 
         // Unrecoverable error, abort decoding
         if(decoded == 0xFFFF)
@@ -68,8 +68,7 @@ void M17FrameEncoder::encodeLsf(M17LinkSetupFrame& lsf, frame_t& output)
 
     std::array<uint8_t, 46> punctured;
     puncture(encoded, punctured, LSF_PUNCTURE);
-    interleave(punctured);
-    decorrelate(punctured);
+    interleaveAndDecorrelate(punctured);
 
     // Copy data to output buffer, prepended with sync word.
     auto it = std::copy(LSF_SYNC_WORD.begin(), LSF_SYNC_WORD.end(),
@@ -106,8 +105,7 @@ uint16_t M17FrameEncoder::encodeStreamFrame(const payload_t& payload,
     // Increment LICH counter after copy
     currentLich = (currentLich + 1) % lichSegments.size();
 
-    interleave(frame);
-    decorrelate(frame);
+    interleaveAndDecorrelate(frame);
 
     // Copy data to output buffer, prepended with sync word.
     auto oIt = std::copy(STREAM_SYNC_WORD.begin(), STREAM_SYNC_WORD.end(),
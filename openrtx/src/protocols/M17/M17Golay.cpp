@@ -33,87 +33,207 @@ static constexpr uint16_t encode_matrix[12] =
     0xd99, 0x3da, 0x7b4, 0xf68, 0x63b, 0xc75
 };
 
+/*
+ * Number of least reliable bits tested by the Chase soft-decision decoder,
+ * resulting in 2^N candidate codewords.
+ */
+static constexpr uint8_t CHASE_BITS = 4;
 
 /*
- * Data decoding matrix for Golay(24,12) code with generator polynomial 0xC75
+ * Maximum discrepancy between the received bits and the decoded codeword,
+ * expressed as the sum of the reliabilities of the flipped bits. Up to two
+ * full-confidence bit errors plus some low-confidence ones are accepted, as
+ * with a larger discrepancy the received word is likely noise or a different
+ * codeword. Hard-decision input is not subject to this limit.
  */
-static constexpr uint16_t decode_matrix[12] =
+static constexpr uint32_t MAX_METRIC = (0x7FFF * 5) / 2;
+
+/*
+ * Lookup tables for Golay(24,12) encoding and decoding, generated at compile
+ * time and stored in flash.
+ * The checksum tables contain the checksum of each nibble of the data word,
+ * the checksum of a 12-bit value being the XOR of three table entries.
+ * The syndrome table maps each of the 4096 syndromes to the data part of the
+ * minimum weight error pattern generating it. Since the parity part of the
+ * error pattern can be obtained back from the syndrome, only the data part is
+ * stored. Syndromes not corresponding to an error pattern of weight three or
+ * less are marked as uncorrectable with the 0xFFFF value.
+ */
+struct GolayTables
 {
-    0xc75, 0x49f, 0x93e, 0x6e3, 0xdc6, 0xf13,
-    0xab9, 0x1ed, 0x3da, 0x7b4, 0xf68, 0xa4f
+    uint16_t checksum[3][16];
+    uint16_t syndrome[4096];
 };
 
-
-uint16_t Golay24::calcChecksum(const uint16_t& value)
+static constexpr uint16_t checksumOf(const uint16_t value)
 {
     uint16_t checksum = 0;
 
     for(uint8_t i = 0; i < 12; i++)
     {
         if(value & (1 << i))
-        {
             checksum ^= encode_matrix[i];
-        }
     }
 
     return checksum;
 }
 
-
-/**
- * Detect and correct errors in a Golay(24,12) codeword.
- *
- * @param codeword: input codeword.
- * @return bitmask corresponding to detected bit errors in the codeword, or
- * 0xFFFFFFFF if bit errors are unrecoverable.
- */
-uint32_t Golay24::detectErrors(const uint32_t& codeword)
+static constexpr uint16_t syndromeOf(const uint32_t errors)
 {
-    uint16_t data   = codeword >> 12;
-    uint16_t parity = codeword & 0xFFF;
+    return (errors & 0xFFF) ^ checksumOf((errors >> 12) & 0xFFF);
+}
 
-    uint16_t syndrome = parity ^ calcChecksum(data);
+static constexpr GolayTables makeTables()
+{
+    GolayTables tables{};
 
-    if(__builtin_popcount(syndrome) <= 3)
+    for(uint8_t i = 0; i < 3; i++)
     {
-        return syndrome;
+        for(uint8_t n = 0; n < 16; n++)
+            tables.checksum[i][n] = checksumOf(n << (4 * i));
     }
 
-    for(uint8_t i = 0; i<12; i++)
+    for(uint16_t i = 0; i < 4096; i++)
+        tables.syndrome[i] = 0xFFFF;
+
+    tables.syndrome[0] = 0;
+
+    for(uint8_t i = 0; i < 24; i++)
     {
-        uint16_t e = 1 << i;
-        uint16_t coded_error = encode_matrix[i];
+        uint32_t e1 = 1UL << i;
+        tables.syndrome[syndromeOf(e1)] = e1 >> 12;
 
-        if(__builtin_popcount(syndrome^coded_error) <= 2)
+        for(uint8_t j = 0; j < i; j++)
         {
-            return (e << 12) | (syndrome ^ coded_error);
+            uint32_t e2 = e1 | (1UL << j);
+            tables.syndrome[syndromeOf(e2)] = e2 >> 12;
+
+            for(uint8_t k = 0; k < j; k++)
+            {
+                uint32_t e3 = e2 | (1UL << k);
+                tables.syndrome[syndromeOf(e3)] = e3 >> 12;
+            }
         }
     }
 
+    return tables;
+}
 
-    uint16_t inv_syndrome = 0;
-    for(uint8_t i = 0; i < 12; i++)
+static constexpr GolayTables tables = makeTables();
+
+
+uint16_t Golay24::calcChecksum(const uint16_t& value)
+{
+    return tables.checksum[0][ value       & 0x0F]
+         ^ tables.checksum[1][(value >> 4) & 0x0F]
+         ^ tables.checksum[2][(value >> 8) & 0x0F];
+}
+
+uint32_t Golay24::detectErrors(const uint32_t& codeword)
+{
+    uint16_t data     = (codeword >> 12) & 0xFFF;
+    uint16_t parity   = codeword & 0xFFF;
+    uint16_t syndrome = parity ^ calcChecksum(data);
+    uint16_t dataErr  = tables.syndrome[syndrome];
+
+    if(dataErr == 0xFFFF)
+        return 0xFFFFFFFF;
+
+    uint16_t parityErr = syndrome ^ calcChecksum(dataErr);
+    return (static_cast< uint32_t >(dataErr) << 12) | parityErr;
+}
+
+uint32_t Golay24::softDecode(const uint16_t *bits)
+{
+    uint32_t hard      = 0;
+    bool     saturated = true;
+    uint16_t reliability[24];
+    uint8_t  weakest[CHASE_BITS];
+
+    // Slice the soft bits and keep track of the least reliable positions.
+    // Reliabilities are indexed by codeword bit, the first soft bit is the
+    // most significant one.
+    for(uint8_t i = 0; i < 24; i++)
     {
-        if(syndrome & (1 << i))
+        uint8_t pos  = 23 - i;
+        bool    bit  = bits[i] > 0x7FFF;
+        uint16_t rel = bit ? (bits[i] - 0x7FFF) : (0x7FFF - bits[i]);
+
+        hard |= static_cast< uint32_t >(bit) << pos;
+        reliability[pos] = rel;
+
+        if(rel < 0x7FFF)
+            saturated = false;
+
+        if(i < CHASE_BITS)
+        {
+            weakest[i] = pos;
+            continue;
+        }
+
+        uint8_t max = 0;
+        for(uint8_t j = 1; j < CHASE_BITS; j++)
         {
-            inv_syndrome ^= decode_matrix[i];
+            if(reliability[weakest[j]] > reliability[weakest[max]])
+                max = j;
         }
+
+        if(rel < reliability[weakest[max]])
+            weakest[max] = pos;
     }
 
-    if(__builtin_popcount(inv_syndrome) <= 3)
+    // Hard-decision input, all the bits have the same reliability: the soft
+    // metric brings no information, use the algebraic decoder which corrects
+    // up to three errors.
+    if(saturated)
     {
-        return inv_syndrome << 12;
+        uint32_t errors = detectErrors(hard);
+        if(errors == 0xFFFFFFFF)
+            return 0xFFFFFFFF;
+
+        return hard ^ errors;
     }
 
-    for(uint8_t i = 0; i < 12; i++ )
+    // Chase-II decoding: flip every combination of the least reliable bits,
+    // run the hard-decision decoder on each test pattern and choose the
+    // candidate codeword with the lowest discrepancy from the received bits,
+    // rejecting it if the discrepancy is too high.
+    uint32_t best       = 0xFFFFFFFF;
+    uint32_t bestMetric = 0xFFFFFFFF;
+
+    for(uint8_t pattern = 0; pattern < (1 << CHASE_BITS); pattern++)
     {
-        uint16_t e = 1 << i;
-        uint16_t coding_error = decode_matrix[i];
-        if(__builtin_popcount(inv_syndrome ^ coding_error) <= 2 )
+        uint32_t test = hard;
+        for(uint8_t i = 0; i < CHASE_BITS; i++)
+        {
+            if(pattern & (1 << i))
+                test ^= 1UL << weakest[i];
+        }
+
+        uint32_t errors = detectErrors(test);
+        if(errors == 0xFFFFFFFF)
+            continue;
+
+        uint32_t candidate = test ^ errors;
+        uint32_t diff      = candidate ^ hard;
+        uint32_t metric    = 0;
+
+        while(diff != 0)
+        {
+            uint8_t pos = __builtin_ctz(diff);
+            metric += reliability[pos];
+            diff   &= diff - 1;
+        }
+
+        if(metric < bestMetric)
         {
-            return ((inv_syndrome ^ coding_error) << 12) | e;
+            best       = candidate;
+            bestMetric = metric;
         }
     }
 
-    return 0xFFFFFFFF;
+    if(bestMetric > MAX_METRIC)
+        return 0xFFFFFFFF;
+
+    return best;
 }
@@ -26,10 +26,6 @@
 #include <M17/M17Utils.hpp>
 #include <M17/M17DSP.hpp>
 
-#if defined(PLATFORM_LINUX)
-#include <stdio.h>
-#endif
-
 using namespace M17;
 
 
@@ -53,6 +49,7 @@ void M17Modulator::init()
     baseband_buffer = std::make_unique< int16_t[] >(2 * M17_FRAME_SAMPLES);
     idleBuffer      = baseband_buffer.get();
     txRunning       = false;
+    rrcInterp.reset();
     #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
     pwmComp.reset();
     #endif
@@ -89,7 +86,6 @@ void M17Modulator::start()
 
     // Generate baseband signal and then start transmission
     symbolsToBaseband();
-    #ifndef PLATFORM_LINUX
     outPath = audioPath_request(SOURCE_MCU, SINK_RTX, PRIO_TX);
     if(outPath < 0)
     {
@@ -101,9 +97,6 @@ void M17Modulator::start()
                                   2*M17_FRAME_SAMPLES, M17_TX_SAMPLE_RATE,
                                   STREAM_OUTPUT | BUF_CIRC_DOUBLE);
     idleBuffer = outputStream_getIdleBuffer(outStream);
-    #else
-    sendBaseband();
-    #endif
 
     // Repeat baseband generation and transmission, this makes the preamble to
     // be long 80ms (two frames)
@@ -134,6 +127,7 @@ void M17Modulator::stop()
     txRunning  = false;
     idleBuffer = baseband_buffer.get();
     audioPath_release(outPath);
+    rrcInterp.reset();
 
     #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
     pwmComp.reset();
@@ -148,26 +142,29 @@ void M17Modulator::invertPhase(const bool status)
 
 void M17Modulator::symbolsToBaseband()
 {
-    memset(idleBuffer, 0x00, M17_FRAME_SAMPLES * sizeof(stream_sample_t));
+    // Polyphase interpolation of the symbol stream, producing directly the
+    // 48kHz baseband. PWM compensation and phase inversion are applied to the
+    // output samples in the same pass.
+    std::array< float, M17_SAMPLES_PER_SYMBOL > samples;
+    stream_sample_t *out = idleBuffer;
 
     for(size_t i = 0; i < symbols.size(); i++)
     {
-        idleBuffer[i * 10] = symbols[i];
-    }
-
-    for(size_t i = 0; i < M17_FRAME_SAMPLES; i++)
-    {
-        float elem    = static_cast< float >(idleBuffer[i]);
-        elem          = M17::rrc_48k(elem * M17_RRC_GAIN) - M17_RRC_OFFSET;
-        #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
-        elem          = pwmComp(elem);
-        #endif
-        if(invPhase) elem = 0.0f - elem;    // Invert signal phase
-        idleBuffer[i] = static_cast< int16_t >(elem);
+        float elem = static_cast< float >(symbols[i]) * M17_RRC_GAIN;
+        rrcInterp(elem, samples.data());
+
+        for(size_t j = 0; j < M17_SAMPLES_PER_SYMBOL; j++)
+        {
+            elem = samples[j] - M17_RRC_OFFSET;
+            #if defined(PLATFORM_MD3x0) || defined(PLATFORM_MDUV3x0)
+            elem = pwmComp(elem);
+            #endif
+            if(invPhase) elem = 0.0f - elem;    // Invert signal phase
+            *out++ = static_cast< int16_t >(elem);
+        }
     }
 }
 
-#ifndef PLATFORM_LINUX
 void M17Modulator::sendBaseband()
 {
     if(txRunning == false) return;
@@ -177,17 +174,3 @@ void M17Modulator::sendBaseband()
     outputStream_sync(outStream, true);
     idleBuffer = outputStream_getIdleBuffer(outStream);
 }
-#else
-void M17Modulator::sendBaseband()
-{
-    FILE *outfile = fopen("/tmp/m17_output.raw", "ab");
-
-    for(size_t i = 0; i < M17_FRAME_SAMPLES; i++)
-    {
-        auto s = idleBuffer[i];
-        fwrite(&s, sizeof(s), 1, outfile);
-    }
-
-    fclose(outfile);
-}
-#endif
@@ -0,0 +1,300 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <M17/M17MultiDemodulator.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace M17;
+
+struct WorkerArgs
+{
+    M17MultiDemodulator *engine;
+    size_t               index;
+};
+
+M17MultiDemodulator::M17MultiDemodulator(const uint32_t sampleRate,
+                                         const size_t channels,
+                                         const size_t workers,
+                                         FrameCallback callback) :
+    channelizer(channels), chanOut(channels), callback(callback),
+    workers(workers), generation(0), pending(0), quit(false)
+{
+    spacing  = static_cast< float >(sampleRate) / channels;
+    chanRate = 2.0f * spacing;
+
+    for(size_t i = 0; i < channels; i++)
+    {
+        auto ch = std::make_unique< Channel >();
+        ch->demod.init();
+        ch->decoder.reset();
+        ch->prev     = 1.0f;
+        ch->last     = 0.0f;
+        ch->resPos   = 0.0f;
+        ch->blockLen = 0;
+        ch->energy   = 0.0f;
+        ch->power    = 0.0f;
+        ch->open     = false;
+        ch->stats    = {0, 0, 0, 0, 0};
+        chans.push_back(std::move(ch));
+    }
+
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+
+    for(size_t i = 0; i < this->workers.size(); i++)
+    {
+        WorkerArgs *args = new WorkerArgs{this, i};
+        pthread_create(&this->workers[i], NULL, workerFunc, args);
+    }
+}
+
+M17MultiDemodulator::~M17MultiDemodulator()
+{
+    pthread_mutex_lock(&mutex);
+    quit = true;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+
+    for(auto& thread : workers)
+        pthread_join(thread, NULL);
+
+    pthread_mutex_destroy(&mutex);
+    pthread_cond_destroy(&cond);
+}
+
+void M17MultiDemodulator::process(const std::complex< float > *samples,
+                                  const size_t length)
+{
+    for(size_t i = 0; i < length; i++)
+        channelize(samples[i]);
+
+    dispatch();
+}
+
+void M17MultiDemodulator::process(const int16_t *samples, const size_t length)
+{
+    for(size_t i = 0; i < length; i++)
+        channelize(std::complex< float >(samples[i] / 32768.0f, 0.0f));
+
+    dispatch();
+}
+
+float M17MultiDemodulator::channelFrequency(const size_t channel) const
+{
+    float index = static_cast< float >(channel);
+    if(channel >= (chans.size() / 2))
+        index -= chans.size();
+
+    return index * spacing;
+}
+
+M17MultiDemodulator::ChannelStats M17MultiDemodulator::getStats(const size_t channel) const
+{
+    return chans.at(channel)->stats;
+}
+
+void M17MultiDemodulator::channelize(const std::complex< float > sample)
+{
+    if(channelizer(sample, chanOut.data()) == false)
+        return;
+
+    for(size_t i = 0; i < chans.size(); i++)
+    {
+        chans[i]->input.push_back(chanOut[i]);
+        chans[i]->energy += std::norm(chanOut[i]);
+    }
+}
+
+void M17MultiDemodulator::updateSquelch()
+{
+    std::vector< float > powers;
+
+    for(auto& ch : chans)
+    {
+        if(ch->input.empty())
+            return;
+
+        float power = ch->energy / ch->input.size();
+        ch->energy  = 0.0f;
+
+        if(ch->power == 0.0f)
+            ch->power = power;
+        else
+            ch->power += SQL_ALPHA * (power - ch->power);
+
+        powers.push_back(ch->power);
+    }
+
+    // Noise floor: median of the channel powers
+    size_t mid = powers.size() / 2;
+    std::nth_element(powers.begin(), powers.begin() + mid, powers.end());
+    const float threshold = powers[mid] * SQL_RATIO;
+
+    for(auto& ch : chans)
+    {
+        bool open = (ch->power > threshold);
+
+        // Restart the demodulation from scratch when the squelch closes
+        if(ch->open && (open == false))
+        {
+            ch->demod.init();
+            ch->decoder.reset();
+            ch->blockLen = 0;
+        }
+
+        ch->open = open;
+    }
+}
+
+void M17MultiDemodulator::dispatch()
+{
+    updateSquelch();
+
+    if(workers.empty())
+    {
+        for(size_t i = 0; i < chans.size(); i++)
+            processChannel(i);
+
+        return;
+    }
+
+    pthread_mutex_lock(&mutex);
+    generation += 1;
+    pending     = workers.size();
+    pthread_cond_broadcast(&cond);
+
+    while(pending > 0)
+        pthread_cond_wait(&cond, &mutex);
+
+    pthread_mutex_unlock(&mutex);
+}
+
+void *M17MultiDemodulator::workerFunc(void *arg)
+{
+    WorkerArgs *args = reinterpret_cast< WorkerArgs * >(arg);
+    M17MultiDemodulator *engine = args->engine;
+    const size_t index = args->index;
+    delete args;
+
+    uint32_t done = 0;
+
+    while(1)
+    {
+        pthread_mutex_lock(&engine->mutex);
+        while((engine->quit == false) && (engine->generation == done))
+            pthread_cond_wait(&engine->cond, &engine->mutex);
+
+        if(engine->quit)
+        {
+            pthread_mutex_unlock(&engine->mutex);
+            break;
+        }
+
+        done = engine->generation;
+        pthread_mutex_unlock(&engine->mutex);
+
+        // Channels are statically assigned to the workers
+        const size_t stride = engine->workers.size();
+        for(size_t i = index; i < engine->chans.size(); i += stride)
+            engine->processChannel(i);
+
+        pthread_mutex_lock(&engine->mutex);
+        engine->pending -= 1;
+        if(engine->pending == 0)
+            pthread_cond_broadcast(&engine->cond);
+        pthread_mutex_unlock(&engine->mutex);
+    }
+
+    return NULL;
+}
+
+void M17MultiDemodulator::processChannel(const size_t index)
+{
+    Channel& ch = *chans[index];
+    const float fmScale = (chanRate * FREQ_SCALE) / (2.0f * M_PI);
+    const float resStep = chanRate / RX_RATE;
+
+    if(ch.open == false)
+    {
+        if(ch.input.empty() == false)
+            ch.prev = ch.input.back();
+
+        ch.input.clear();
+        return;
+    }
+
+    for(const auto& sample : ch.input)
+    {
+        // FM discriminator: phase difference between consecutive samples
+        float value = std::arg(sample * std::conj(ch.prev)) * fmScale;
+        ch.prev = sample;
+
+        // Linear interpolation down to the demodulator sample rate
+        while(ch.resPos <= 1.0f)
+        {
+            float out = ch.last + ((value - ch.last) * ch.resPos);
+            if(out > 32767.0f)  out = 32767.0f;
+            if(out < -32768.0f) out = -32768.0f;
+
+            ch.block[ch.blockLen] = static_cast< int16_t >(out);
+            ch.blockLen  += 1;
+            ch.resPos    += resStep;
+
+            if(ch.blockLen < BLOCK_SIZE)
+                continue;
+
+            ch.blockLen = 0;
+            if(ch.demod.process(ch.block, BLOCK_SIZE) == false)
+                continue;
+
+            auto type = ch.decoder.decodeFrame(ch.demod.getSoftFrame());
+            ch.stats.frames += 1;
+
+            switch(type)
+            {
+                case M17FrameType::LINK_SETUP:
+                    ch.stats.lsf += 1;
+                    if(ch.decoder.getLsf().valid())
+                        ch.stats.validLsf += 1;
+                    break;
+
+                case M17FrameType::STREAM:
+                    ch.stats.stream += 1;
+                    break;
+
+                case M17FrameType::PACKET:
+                    ch.stats.packet += 1;
+                    break;
+
+                default:
+                    break;
+            }
+
+            if(callback)
+                callback(index, type, ch.decoder);
+        }
+
+        ch.resPos -= 1.0f;
+        ch.last    = value;
+    }
+
+    ch.input.clear();
+}
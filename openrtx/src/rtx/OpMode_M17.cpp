@@ -191,7 +191,7 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
         // Process new data
         if(newData)
         {
-            auto& frame   = demodulator.getFrame();
+            auto& frame   = demodulator.getSoftFrame();
             auto  type    = decoder.decodeFrame(frame);
             auto  lsf     = decoder.getLsf();
             status->lsfOk = lsf.valid();
@@ -259,12 +259,12 @@ void OpMode_M17::rxState(rtxStatus_t *const status)
                 if((type == M17FrameType::STREAM) && (pthSts == PATH_OPEN))
                 {
                     // (re)start codec2 module if not already up
-                    if(codec_running() == false)
-                        codec_startDecode(rxAudioPath);
+                    if(codec_running(rxAudioPath) == false)
+                        codec_startDecode(rxAudioPath, true);
 
                     M17StreamFrame sf = decoder.getStreamFrame();
-                    codec_pushFrame(sf.payload().data(),     false);
-                    codec_pushFrame(sf.payload().data() + 8, false);
+                    codec_pushFrame(rxAudioPath, sf.payload().data(),     false);
+                    codec_pushFrame(rxAudioPath, sf.payload().data() + 8, false);
                 }
             }
         }
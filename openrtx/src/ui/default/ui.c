@@ -70,6 +70,7 @@
 #include <interfaces/platform.h>
 #include <interfaces/display.h>
 #include <interfaces/cps_io.h>
+#include <cps_cache.h>
 #include <interfaces/nvmem.h>
 #include <interfaces/delays.h>
 #include <string.h>
@@ -206,6 +207,8 @@ const char *info_items[] =
     "VHF",
     "UHF",
     "Hw Version",
+    "Voice buffer",
+    "Voice late/PLC",
 #ifdef PLATFORM_TTWRPLUS
     "Radio",
     "Radio FW",
@@ -597,13 +600,13 @@ static int _ui_fsm_loadChannel(int16_t channel_index, bool *sync_rtx)
     if(state.bank_enabled)
     {
         bankHdr_t bank = { 0 };
-        cps_readBankHeader(&bank, state.bank);
+        cpsCache_readBankHeader(&bank, state.bank);
         if((channel_index < 0) || (channel_index >= bank.ch_count))
             return -1;
         channel_index = cps_readBankData(state.bank, channel_index);
     }
 
-    int result = cps_readChannel(&channel, channel_index);
+    int result = cpsCache_readChannel(&channel, channel_index);
     // Read successful and channel is valid
     if((result != -1) && _ui_channel_valid(&channel))
     {
@@ -1815,19 +1818,19 @@ void ui_updateFSM(bool *sync_rtx)
                         // manu_selected is 0-based
                         // bank 0 means "All Channel" mode
                         // banks (1, n) are mapped to banks (0, n-1)
-                        if(cps_readBankHeader(&bank, ui_state.menu_selected) != -1)
+                        if(cpsCache_readBankHeader(&bank, ui_state.menu_selected) != -1)
                             ui_state.menu_selected += 1;
                     }
                     else if(state.ui_screen == MENU_CHANNEL)
                     {
                         channel_t channel;
-                        if(cps_readChannel(&channel, ui_state.menu_selected + 1) != -1)
+                        if(cpsCache_readChannel(&channel, ui_state.menu_selected + 1) != -1)
                             ui_state.menu_selected += 1;
                     }
                     else if(state.ui_screen == MENU_CONTACTS)
                     {
                         contact_t contact;
-                        if(cps_readContact(&contact, ui_state.menu_selected + 1) != -1)
+                        if(cpsCache_readContact(&contact, ui_state.menu_selected + 1) != -1)
                             ui_state.menu_selected += 1;
                     }
                 }
@@ -1843,7 +1846,7 @@ void ui_updateFSM(bool *sync_rtx)
                         else
                         {
                             state.bank_enabled = true;
-                            result = cps_readBankHeader(&newbank, ui_state.menu_selected - 1);
+                            result = cpsCache_readBankHeader(&newbank, ui_state.menu_selected - 1);
                         }
                         if(result != -1)
                         {
@@ -26,11 +26,13 @@
 #include <ui/ui_default.h>
 #include <interfaces/nvmem.h>
 #include <interfaces/cps_io.h>
+#include <cps_cache.h>
 #include <interfaces/platform.h>
 #include <interfaces/delays.h>
 #include <memory_profiling.h>
 #include <ui/ui_strings.h>
 #include <core/voicePromptUtils.h>
+#include <core/audio_codec.h>
 
 #ifdef PLATFORM_TTWRPLUS
 #include <SA8x8.h>
@@ -497,6 +499,7 @@ int _ui_getInfoEntryName(char *buf, uint8_t max_len, uint8_t index)
 int _ui_getInfoValueName(char *buf, uint8_t max_len, uint8_t index)
 {
     const hwInfo_t* hwinfo = platform_getHwInfo();
+    codecStats_t codecStats;
     if(index >= info_num) return -1;
     switch(index)
     {
@@ -533,11 +536,20 @@ int _ui_getInfoValueName(char *buf, uint8_t max_len, uint8_t index)
         case 8: // LCD Type
             sniprintf(buf, max_len, "%d", hwinfo->hw_version);
             break;
+        case 9: // Voice playout buffer depth
+            codec_getStats(&codecStats);
+            sniprintf(buf, max_len, "%d/%d", codecStats.depth, codecStats.target);
+            break;
+        case 10: // Voice late and concealed frames
+            codec_getStats(&codecStats);
+            sniprintf(buf, max_len, "%"PRIu32"/%"PRIu32, codecStats.late,
+                      codecStats.concealed);
+            break;
         #ifdef PLATFORM_TTWRPLUS
-        case 9: // Radio model
+        case 11: // Radio model
             strncpy(buf, sa8x8_getModel(), max_len);
             break;
-        case 10: // Radio firmware version
+        case 12: // Radio firmware version
         {
             // Get FW version string, skip the first nine chars ("sa8x8-fw/")
             uint8_t major, minor, patch, release;
@@ -563,7 +575,7 @@ int _ui_getBankName(char *buf, uint8_t max_len, uint8_t index)
     else
     {
         bankHdr_t bank;
-        result = cps_readBankHeader(&bank, index - 1);
+        result = cpsCache_readBankHeader(&bank, index - 1);
         if(result != -1)
             sniprintf(buf, max_len, "%s", bank.name);
     }
@@ -573,7 +585,7 @@ int _ui_getBankName(char *buf, uint8_t max_len, uint8_t index)
 int _ui_getChannelName(char *buf, uint8_t max_len, uint8_t index)
 {
     channel_t channel;
-    int result = cps_readChannel(&channel, index);
+    int result = cpsCache_readChannel(&channel, index);
     if(result != -1)
         sniprintf(buf, max_len, "%s", channel.name);
     return result;
@@ -582,7 +594,7 @@ int _ui_getChannelName(char *buf, uint8_t max_len, uint8_t index)
 int _ui_getContactName(char *buf, uint8_t max_len, uint8_t index)
 {
     contact_t contact;
-    int result = cps_readContact(&contact, index);
+    int result = cpsCache_readContact(&contact, index);
     if(result != -1)
         sniprintf(buf, max_len, "%s", contact.name);
     return result;
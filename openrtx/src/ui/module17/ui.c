@@ -125,6 +125,8 @@ const char *info_items[] =
     "Hw Version",
     "HMI",
     "BB Tuning Pot",
+    "Voice buffer",
+    "Voice late/PLC",
 };
 
 const char *authors[] =
@@ -20,6 +20,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <utils.h>
 #include <ui/ui_mod17.h>
@@ -29,6 +30,7 @@
 #include <interfaces/delays.h>
 #include <memory_profiling.h>
 #include <hwconfig.h>
+#include <audio_codec.h>
 
 /* UI main screen helper functions, their implementation is in "ui_main.c" */
 extern void _ui_drawMainBottom();
@@ -287,6 +289,7 @@ int _ui_getInfoEntryName(char *buf, uint8_t max_len, uint8_t index)
 int _ui_getInfoValueName(char *buf, uint8_t max_len, uint8_t index)
 {
     const hwInfo_t* hwinfo = platform_getHwInfo();
+    codecStats_t codecStats;
     if(index >= info_num) return -1;
     switch(index)
     {
@@ -319,6 +322,15 @@ int _ui_getInfoValueName(char *buf, uint8_t max_len, uint8_t index)
                 snprintf(buf, max_len, "%s", bbTuningPot[1]);
         #endif
             break;
+        case 5: // Voice playout buffer depth
+            codec_getStats(&codecStats);
+            snprintf(buf, max_len, "%d/%d", codecStats.depth, codecStats.target);
+            break;
+        case 6: // Voice late and concealed frames
+            codec_getStats(&codecStats);
+            snprintf(buf, max_len, "%"PRIu32"/%"PRIu32, codecStats.late,
+                     codecStats.concealed);
+            break;
     }
     return 0;
 }
@@ -19,210 +19,579 @@
  ***************************************************************************/
 
 #include <interfaces/cps_io.h>
+#include <cps_cache.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
+#include <unistd.h>
 
-#define CPS_CHUNK_SIZE 1024
+/*
+ * The whole codeplug is loaded in RAM when opened: reads are served directly
+ * from the cached image, accessing the packed data structures in place, while
+ * modifications are applied to the cached image. When the codeplug is closed
+ * only the modified range of the image is written back to the file.
+ */
+
+// Number of record slots allocated at once when no free slot is available
+#define CPS_RECORD_CHUNK 16
+
+// Number of separately tracked modified ranges: an edit usually touches the
+// header, a record and the index tables at the end of the image.
+#define CPS_DIRTY_RANGES 3
+
+typedef struct
+{
+    size_t lo;  // Start of the modified image range
+    size_t hi;  // End of the modified image range
+}
+dirtyRange_t;
 
-static FILE *cps_file = NULL;
+static FILE     *cps_file  = NULL;
+static uint8_t  *cps_data  = NULL;   // Cached codeplug image
+static size_t    cps_size  = 0;      // Size of the codeplug image, in bytes
+static size_t    file_size = 0;      // Size of the codeplug file, in bytes
+static dirtyRange_t dirty[CPS_DIRTY_RANGES]; // Modified image ranges
+static uint8_t   dirty_num = 0;      // Number of modified image ranges
+static bool      cps_valid = false;  // Codeplug header is valid
+static uint16_t *ct_pos    = NULL;   // Contact record ID to list position
+static uint16_t *ch_pos    = NULL;   // Channel record ID to list position
+static bool      maps_valid = false; // Record ID to position maps are valid
 const char *default_author = "Codeplug author.";
 const char *default_descr = "Codeplug description.";
 
 /**
- * Internal: read and validate codeplug header
+ * Internal: get a pointer to the header of the cached codeplug.
  *
- * @param header: pointer to the header struct to be populated
- * @return 0 on success, -1 on failure
+ * @return pointer to the codeplug header.
  */
-int _readHeader(cps_header_t *header)
+static inline cps_header_t *_header()
 {
-    fseek(cps_file, 0L, SEEK_SET);
-    fread(header, sizeof(cps_header_t), 1, cps_file);
-    // Validate magic number
-    if(header->magic != CPS_MAGIC)
-        return -1;
-    // Validate version number
-    if(((header->version_number & 0xff00) >> 8) != CPS_VERSION_MAJOR ||
-        (header->version_number & 0x00ff) > CPS_VERSION_MINOR)
-        return -1;
-    return 0;
+    return (cps_header_t *) cps_data;
 }
 
 /**
- * Internal: write codeplug header
+ * Internal: get a pointer to the record allocation data of the cached
+ * codeplug.
  *
- * @param header: header struct to be written
- * @return 0 on success, -1 on failure
+ * @return pointer to the record allocation data.
  */
-int _writeHeader(cps_header_t header)
+static inline cps_records_t *_records()
 {
-    fseek(cps_file, 0L, SEEK_SET);
-    fwrite(&header, sizeof(cps_header_t), 1, cps_file);
-    return 0;
+    return (cps_records_t *) (cps_data + sizeof(cps_header_t));
 }
 
 /**
- * Internal: push down data at a given offset by a given amount
+ * Internal: mark a range of the codeplug image as modified.
+ *
+ * @param start: start offset of the modified range.
+ * @param end: end offset of the modified range.
+ */
+static void _setDirty(size_t start, size_t end)
+{
+    // Records cached for the UI may have been changed
+    cpsCache_invalidate();
+
+    // Extend an overlapping or adjacent range or, if there is none and all the
+    // ranges are in use, the nearest one.
+    int    sel = -1;
+    size_t gap = SIZE_MAX;
+    for(int i = 0; i < dirty_num; i++)
+    {
+        size_t dist = 0;
+        if(start > dirty[i].hi)
+            dist = start - dirty[i].hi;
+        else if(end < dirty[i].lo)
+            dist = dirty[i].lo - end;
+
+        if(dist < gap)
+        {
+            sel = i;
+            gap = dist;
+        }
+    }
+
+    if((gap > 0) && (dirty_num < CPS_DIRTY_RANGES))
+    {
+        dirty[dirty_num].lo = start;
+        dirty[dirty_num].hi = end;
+        dirty_num += 1;
+        return;
+    }
+
+    if(start < dirty[sel].lo) dirty[sel].lo = start;
+    if(end   > dirty[sel].hi) dirty[sel].hi = end;
+
+    // The extended range may now overlap other ones: merge them
+    for(int i = dirty_num - 1; i >= 0; i--)
+    {
+        if((i == sel) || (dirty[i].lo > dirty[sel].hi) ||
+           (dirty[i].hi < dirty[sel].lo))
+            continue;
+
+        if(dirty[i].lo < dirty[sel].lo) dirty[sel].lo = dirty[i].lo;
+        if(dirty[i].hi > dirty[sel].hi) dirty[sel].hi = dirty[i].hi;
+
+        dirty_num -= 1;
+        dirty[i]   = dirty[dirty_num];
+        if(sel == dirty_num)
+            sel = i;
+    }
+}
+
+/**
+ * Internal: copy data to the codeplug image, marking it as modified.
+ */
+static inline void _write(size_t offset, const void *data, size_t size)
+{
+    memcpy(cps_data + offset, data, size);
+    _setDirty(offset, offset + size);
+}
+
+static inline uint16_t _read16(size_t offset)
+{
+    uint16_t value;
+    memcpy(&value, cps_data + offset, sizeof(uint16_t));
+    return value;
+}
+
+static inline void _write16(size_t offset, uint16_t value)
+{
+    _write(offset, &value, sizeof(uint16_t));
+}
+
+static inline uint32_t _read32(size_t offset)
+{
+    uint32_t value;
+    memcpy(&value, cps_data + offset, sizeof(uint32_t));
+    return value;
+}
+
+static inline void _write32(size_t offset, uint32_t value)
+{
+    _write(offset, &value, sizeof(uint32_t));
+}
+
+/**
+ * Internal: get the offset of a contact record inside the codeplug image.
+ */
+static inline size_t _contactOffset(uint16_t id)
+{
+    return sizeof(cps_header_t) + sizeof(cps_records_t) + id * sizeof(contact_t);
+}
+
+/**
+ * Internal: get the offset of a channel record inside the codeplug image.
+ */
+static inline size_t _channelOffset(uint16_t id)
+{
+    return _contactOffset(_records()->ct_slots) + id * sizeof(channel_t);
+}
+
+/**
+ * Internal: get the offset of an entry of the bank offset table inside the
+ * codeplug image.
+ */
+static inline size_t _bankTableOffset(uint16_t pos)
+{
+    return _channelOffset(_records()->ch_slots) + pos * sizeof(uint32_t);
+}
+
+/**
+ * Internal: get the offset of a bank header inside the codeplug image.
+ */
+static inline size_t _bankOffset(uint16_t pos)
+{
+    uint16_t b_count = _header()->b_count;
+    return _bankTableOffset(b_count) + _read32(_bankTableOffset(pos));
+}
+
+/**
+ * Internal: get the offset of an entry of the contact index inside the
+ * codeplug image.
+ */
+static inline size_t _ctIndexOffset(uint16_t pos)
+{
+    size_t count = _header()->ct_count + _header()->ch_count;
+    return cps_size - (count - pos) * sizeof(uint16_t);
+}
+
+/**
+ * Internal: get the offset of an entry of the channel index inside the
+ * codeplug image.
+ */
+static inline size_t _chIndexOffset(uint16_t pos)
+{
+    return cps_size - (_header()->ch_count - pos) * sizeof(uint16_t);
+}
+
+/**
+ * Internal: get the number of channels of a bank.
+ */
+static inline uint16_t _bankChCount(size_t b_pos)
+{
+    return ((bankHdr_t *) (cps_data + b_pos))->ch_count;
+}
+
+/**
+ * Internal: open up free space inside the codeplug image, moving down the data
+ * following the given offset.
  *
  * @param offset: offset at which to start to push down data
  * @param amount: amount of free space to be created
  * @return 0 on success, -1 on failure
  */
+static int _pushDown(size_t offset, size_t amount)
+{
+    uint8_t *data = realloc(cps_data, cps_size + amount);
+    if(data == NULL)
+        return -1;
+
+    memmove(data + offset + amount, data + offset, cps_size - offset);
+    cps_data  = data;
+    cps_size += amount;
+    _setDirty(offset, cps_size);
+    return 0;
+}
+
+/**
+ * Internal: remove data from the codeplug image, moving up the data following
+ * the removed range.
+ *
+ * @param offset: offset of the data to be removed
+ * @param amount: amount of data to be removed
+ */
+static void _pullUp(size_t offset, size_t amount)
+{
+    memmove(cps_data + offset, cps_data + offset + amount,
+            cps_size - offset - amount);
+    cps_size -= amount;
+    _setDirty(offset, cps_size);
+}
 
-int _pushDown(uint32_t offset, uint32_t amount)
+/**
+ * Internal: shift the offsets of the banks following a given one.
+ *
+ * @param pos: position of the first bank whose offset has to be updated
+ * @param amount: amount to be added to the bank offsets
+ */
+static void _shiftBankOffsets(uint16_t pos, int32_t amount)
 {
-    // Get end of file
-    fseek(cps_file, 0, SEEK_END);
-    long end = ftell(cps_file);
-    // If offset equals end, just return
-    if (offset == end)
-        return 0;
-    // Move data downwards in chunks of fixed size
-    char buffer[CPS_CHUNK_SIZE] = { 0 };
-    for(int i = 1; i <= ((end - offset) / CPS_CHUNK_SIZE); i++)
+    for(int i = pos; i < _header()->b_count; i++)
     {
-        fseek(cps_file, end - i * CPS_CHUNK_SIZE, SEEK_SET);
-        fread(buffer, CPS_CHUNK_SIZE, 1, cps_file);
-        fseek(cps_file, end - i * CPS_CHUNK_SIZE + amount, SEEK_SET);
-        fwrite(buffer, CPS_CHUNK_SIZE, 1, cps_file);
+        size_t p = _bankTableOffset(i);
+        _write32(p, _read32(p) + amount);
     }
-    // Once initial offset is reached, move the last incomplete block
-    fseek(cps_file, offset, SEEK_SET);
-    fread(buffer, (end - offset) % CPS_CHUNK_SIZE, 1, cps_file);
-    fseek(cps_file, offset + amount, SEEK_SET);
-    fwrite(buffer, (end - offset) % CPS_CHUNK_SIZE, 1, cps_file);
-    fseek(cps_file, offset, SEEK_SET);
-    return 0;
 }
 
 /**
- * Internal: updates the contact numbering after a contact addition or removal
+ * Internal: allocate a contact or channel record slot, taking it from the
+ * free list. When the free list is empty a new chunk of slots is allocated.
  *
- * @param pos: position at which the new contact was inserted or removed
- * @param add: if true a contact was inserted, otherwise it was removed
- * @return 0 on success, -1 on failure
+ * @param channel: if true a channel record is allocated, otherwise a contact.
+ * @return the ID of the allocated record, -1 on failure.
  */
-int _updateCtNumbering(uint16_t pos, bool add)
+static int _allocRecord(bool channel)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    for(int i = 0; i < header.ch_count; i++)
+    cps_records_t rec = *_records();
+    uint16_t slots = channel ? rec.ch_slots : rec.ct_slots;
+    uint16_t first = channel ? rec.ch_free  : rec.ct_free;
+
+    if (first == CPS_NO_RECORD)
     {
-        channel_t c = { 0 };
-        cps_readChannel(&c, i);
-        if (c.mode == OPMODE_M17 && c.m17.contact_index >= pos)
-        {
-            if (add)
-                c.m17.contact_index++;
-            else
-                c.m17.contact_index--;
-            cps_writeChannel(c, i);
-        }
-        if (c.mode == OPMODE_DMR && c.dmr.contact_index >= pos)
+        if (slots > (CPS_NO_RECORD - CPS_RECORD_CHUNK))
+            return -1;
+        size_t offset = channel ? _channelOffset(slots) : _contactOffset(slots);
+        size_t size   = channel ? sizeof(channel_t) : sizeof(contact_t);
+        if (_pushDown(offset, CPS_RECORD_CHUNK * size))
+            return -1;
+        memset(cps_data + offset, 0x00, CPS_RECORD_CHUNK * size);
+        // Chain the new slots in the free list
+        for (int i = 0; i < CPS_RECORD_CHUNK; i++)
         {
-            if (add)
-                c.dmr.contact_index++;
-            else
-                c.dmr.contact_index--;
-            cps_writeChannel(c, i);
+            uint16_t next = slots + i + 1;
+            if (i == (CPS_RECORD_CHUNK - 1))
+                next = CPS_NO_RECORD;
+            _write16(offset + i * size, next);
         }
+        first  = slots;
+        slots += CPS_RECORD_CHUNK;
+        if (channel)
+            rec.ch_slots = slots;
+        else
+            rec.ct_slots = slots;
+        maps_valid = false;
+    }
+
+    // Unlink the first free slot
+    size_t offset = channel ? _channelOffset(first) : _contactOffset(first);
+    if (channel)
+        rec.ch_free = _read16(offset);
+    else
+        rec.ct_free = _read16(offset);
+    _write(sizeof(cps_header_t), &rec, sizeof(cps_records_t));
+    return first;
+}
+
+/**
+ * Internal: put a contact or channel record slot back in the free list.
+ *
+ * @param channel: if true a channel record is freed, otherwise a contact.
+ * @param id: ID of the record to be freed.
+ */
+static void _freeRecord(bool channel, uint16_t id)
+{
+    cps_records_t rec = *_records();
+    if (channel)
+    {
+        _write16(_channelOffset(id), rec.ch_free);
+        rec.ch_free = id;
+    }
+    else
+    {
+        _write16(_contactOffset(id), rec.ct_free);
+        rec.ct_free = id;
     }
+    _write(sizeof(cps_header_t), &rec, sizeof(cps_records_t));
+}
+
+/**
+ * Internal: update the header of the cached codeplug.
+ */
+static inline void _writeHeader(const cps_header_t *header)
+{
+    _write(0, header, sizeof(cps_header_t));
+}
+
+/**
+ * Internal: build the maps from contact and channel record IDs to their list
+ * position, if outdated.
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int _buildMaps()
+{
+    if (maps_valid)
+        return 0;
+    cps_records_t rec = *_records();
+    uint16_t *ct = realloc(ct_pos, (rec.ct_slots + 1) * sizeof(uint16_t));
+    if (ct == NULL)
+        return -1;
+    ct_pos = ct;
+    uint16_t *ch = realloc(ch_pos, (rec.ch_slots + 1) * sizeof(uint16_t));
+    if (ch == NULL)
+        return -1;
+    ch_pos = ch;
+    memset(ct_pos, 0xFF, rec.ct_slots * sizeof(uint16_t));
+    memset(ch_pos, 0xFF, rec.ch_slots * sizeof(uint16_t));
+    for (int i = 0; i < _header()->ct_count; i++)
+        ct_pos[_read16(_ctIndexOffset(i))] = i;
+    for (int i = 0; i < _header()->ch_count; i++)
+        ch_pos[_read16(_chIndexOffset(i))] = i;
+    maps_valid = true;
     return 0;
 }
 
 /**
- * Internal: updates the channel numbering after a channel addition or removal
+ * Internal: get the contact referenced by a channel.
+ *
+ * @param channel: pointer to the channel.
+ * @return the contact index or record ID, CPS_NO_RECORD if none.
+ */
+static uint16_t _getContactRef(const channel_t *channel)
+{
+    if (channel->mode == OPMODE_M17)
+        return channel->m17.contact_index;
+    if (channel->mode == OPMODE_DMR)
+        return channel->dmr.contact_index;
+    return CPS_NO_RECORD;
+}
+
+/**
+ * Internal: set the contact referenced by a channel.
+ *
+ * @param channel: pointer to the channel.
+ * @param ref: contact index or record ID.
+ */
+static void _setContactRef(channel_t *channel, uint16_t ref)
+{
+    if (channel->mode == OPMODE_M17)
+        channel->m17.contact_index = ref;
+    if (channel->mode == OPMODE_DMR)
+        channel->dmr.contact_index = ref;
+}
+
+/**
+ * Internal: convert a codeplug of version 0.1, where contacts and channels are
+ * stored in list order, to the current version.
  *
- * @param pos: position at which the new channel was inserted or removed
- * @param add: if true a channel was inserted, otherwise it was removed
  * @return 0 on success, -1 on failure
  */
-int _updateChNumbering(uint16_t pos, bool add)
+static int _migrate()
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    cps_header_t header = *_header();
+    // Add the record allocation data, one record slot for each item
+    if (_pushDown(sizeof(cps_header_t), sizeof(cps_records_t)))
+        return -1;
+    cps_records_t rec = { header.ct_count, header.ch_count,
+                          CPS_NO_RECORD, CPS_NO_RECORD };
+    _write(sizeof(cps_header_t), &rec, sizeof(cps_records_t));
+    // Add the index tables: the record ID of each item is its old position and
+    // the contact and channel references are already valid record IDs.
+    size_t offset = cps_size;
+    size_t size   = (header.ct_count + header.ch_count) * sizeof(uint16_t);
+    if (_pushDown(offset, size))
+        return -1;
+    for (int i = 0; i < header.ct_count; i++)
+        _write16(offset + i * sizeof(uint16_t), i);
+    offset += header.ct_count * sizeof(uint16_t);
+    for (int i = 0; i < header.ch_count; i++)
+        _write16(offset + i * sizeof(uint16_t), i);
+    header.version_number = CPS_VERSION_MAJOR << 8 | CPS_VERSION_MINOR;
+    _writeHeader(&header);
+    return 0;
+}
+
+/**
+ * Internal: validate the codeplug header, migrating the codeplug to the
+ * current version if needed.
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int _validate()
+{
+    const cps_header_t *header = _header();
+    // Validate magic number
+    if (header->magic != CPS_MAGIC)
+        return -1;
+    // Validate version number
+    if (((header->version_number & 0xff00) >> 8) != CPS_VERSION_MAJOR)
         return -1;
-    for(int i = 0; i < header.b_count; i++)
+    uint8_t minor = header->version_number & 0x00ff;
+    if (minor == 1)
     {
-        bankHdr_t b_header = { 0 };
-        cps_readBankHeader(&b_header, i);
-        for(int j = 0; j < b_header.ch_count; j++)
-        {
-            int32_t ch = cps_readBankData(i, j);
-            if (ch >= pos)
-            {
-                if (add)
-                    ch++;
-                else
-                    ch--;
-                cps_writeBankData(ch, i, j);
-            }
-        }
+        // Contacts, channels and bank offset table have to fit in the image
+        size_t size = sizeof(cps_header_t)
+                    + header->ct_count * sizeof(contact_t)
+                    + header->ch_count * sizeof(channel_t)
+                    + header->b_count  * sizeof(uint32_t);
+        if (cps_size < size)
+            return -1;
+        return _migrate();
+    }
+    if (minor != CPS_VERSION_MINOR)
+        return -1;
+    if (cps_size < (sizeof(cps_header_t) + sizeof(cps_records_t)))
+        return -1;
+    // Record slots, bank offset table and index tables have to fit in the
+    // image, otherwise the offsets computed from them wrap around.
+    const cps_records_t *rec = _records();
+    if ((header->ct_count > rec->ct_slots) || (header->ch_count > rec->ch_slots))
+        return -1;
+    size_t size = _bankTableOffset(header->b_count)
+                + (header->ct_count + header->ch_count) * sizeof(uint16_t);
+    if (cps_size < size)
+        return -1;
+    // Index entries must refer to existing record slots
+    for (int i = 0; i < header->ct_count; i++)
+    {
+        if (_read16(_ctIndexOffset(i)) >= rec->ct_slots)
+            return -1;
+    }
+    for (int i = 0; i < header->ch_count; i++)
+    {
+        if (_read16(_chIndexOffset(i)) >= rec->ch_slots)
+            return -1;
     }
     return 0;
 }
 
 /**
- * Internal: get bank data offset
+ * Internal: write back the modified ranges of the codeplug image.
  *
- * @param pos: position of the bank to be read
- * @return the offset in the file where the bank data is stored, -1 if error
+ * @return 0 on success, -1 on failure
  */
-long _getBankDataOffset(uint16_t pos)
+static int _flush()
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.b_count + 1)
-        return -1;
-    if (pos == header.b_count)
+    if (!cps_file)
+        return 0;
+    for (int i = 0; i < dirty_num; i++)
+    {
+        size_t lo = dirty[i].lo;
+        size_t hi = dirty[i].hi;
+        // Range may extend past the end of an image which has been shrunk
+        if (hi > cps_size)
+            hi = cps_size;
+        if (hi <= lo)
+            continue;
+        fseek(cps_file, lo, SEEK_SET);
+        if (fwrite(cps_data + lo, hi - lo, 1, cps_file) != 1)
+            return -1;
+    }
+    fflush(cps_file);
+    if (cps_size != file_size)
     {
-        // No bank is present, no offset to read
-        if (header.b_count == 0)
-            return ftell(cps_file) +
-                   header.ct_count * sizeof(contact_t) +
-                   header.ch_count * sizeof(channel_t) +
-                   sizeof(uint32_t);
-        // Read last bank offset
-        fseek(cps_file,
-              header.ct_count * sizeof(contact_t) +
-              header.ch_count * sizeof(channel_t) +
-              (header.b_count - 1) * sizeof(uint32_t),
-              SEEK_CUR);
-        uint32_t offset = 0;
-        fread(&offset, sizeof(uint32_t), 1, cps_file);
-        long bdata_pos = ftell(cps_file);
-        bankHdr_t last_bank = { 0 };
-        cps_readBankHeader(&last_bank, header.b_count - 1);
-        return bdata_pos + offset + sizeof(bankHdr_t) + last_bank.ch_count * sizeof(uint32_t);
+        if (ftruncate(fileno(cps_file), cps_size) < 0)
+            return -1;
+        file_size = cps_size;
     }
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          pos * sizeof(uint32_t),
-          SEEK_CUR);
-    uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    return ftell(cps_file) +
-           (header.b_count - pos - 1) * sizeof(uint32_t) +
-           offset;
+    dirty_num = 0;
+    return 0;
 }
 
 int cps_open(char *cps_name)
 {
+    // Close any codeplug still open, saving its modifications
+    if (cps_file)
+        cps_close();
     if (!cps_name)
         cps_name = "default.rtxc";
     cps_file = fopen(cps_name, "r+");
     if (!cps_file)
         return -1;
+    // Load the whole codeplug in RAM
+    fseek(cps_file, 0L, SEEK_END);
+    long size = ftell(cps_file);
+    fseek(cps_file, 0L, SEEK_SET);
+    file_size = (size < 0) ? 0 : size;
+    if ((size < 0) || ((size_t) size < sizeof(cps_header_t)))
+        size = sizeof(cps_header_t);
+    cps_data = calloc(size, 1);
+    if (!cps_data)
+    {
+        fclose(cps_file);
+        cps_file = NULL;
+        return -1;
+    }
+    fread(cps_data, 1, size, cps_file);
+    cps_size   = size;
+    dirty_num  = 0;
+    maps_valid = false;
+    cps_valid  = (_validate() == 0);
+    cpsCache_invalidate();
     return 0;
 }
 
 void cps_close()
 {
+    if (!cps_file)
+        return;
+    if (cps_valid)
+        _flush();
     fclose(cps_file);
+    free(cps_data);
+    free(ct_pos);
+    free(ch_pos);
+    cps_file   = NULL;
+    cps_data   = NULL;
+    ct_pos     = NULL;
+    ch_pos     = NULL;
+    cps_size   = 0;
+    cps_valid  = false;
+    maps_valid = false;
+    cpsCache_invalidate();
 }
 
 int cps_create(char *cps_name)
@@ -246,257 +615,282 @@ int cps_create(char *cps_name)
     header.ch_count = 0;
     header.b_count = 0;
     fwrite(&header, sizeof(cps_header_t), 1, new_cps);
+    // Write empty record allocation data
+    cps_records_t rec = { 0, 0, CPS_NO_RECORD, CPS_NO_RECORD };
+    fwrite(&rec, sizeof(cps_records_t), 1, new_cps);
     fclose(new_cps);
     return 0;
 }
 
 int cps_readContact(contact_t *contact, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.ct_count)
+    if (!cps_valid || pos >= _header()->ct_count)
         return -1;
-    fseek(cps_file, pos * sizeof(contact_t), SEEK_CUR);
-    fread(contact, sizeof(contact_t), 1, cps_file);
+    uint16_t id = _read16(_ctIndexOffset(pos));
+    memcpy(contact, cps_data + _contactOffset(id), sizeof(contact_t));
     return 0;
 }
 
 int cps_readChannel(channel_t *channel, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    if (!cps_valid || pos >= _header()->ch_count)
         return -1;
-    if (pos >= header.ch_count)
+    if (_buildMaps())
         return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          pos * sizeof(channel_t),
-          SEEK_CUR);
-    fread(channel, sizeof(channel_t), 1, cps_file);
+    uint16_t id = _read16(_chIndexOffset(pos));
+    memcpy(channel, cps_data + _channelOffset(id), sizeof(channel_t));
+    // Convert the contact record ID to its position in the contact list
+    uint16_t ref = _getContactRef(channel);
+    if (ref < _records()->ct_slots)
+        _setContactRef(channel, ct_pos[ref]);
     return 0;
 }
 
 int cps_readBankHeader(bankHdr_t *b_header, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.b_count)
-        return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          pos * sizeof(uint32_t),
-          SEEK_CUR);
-    uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    fseek(cps_file, (header.b_count - pos - 1) * sizeof(uint32_t) + offset, SEEK_CUR);
-    fread(b_header, sizeof(bankHdr_t), 1, cps_file);
+    if (!cps_valid || pos >= _header()->b_count)
+        return -1;
+    memcpy(b_header, cps_data + _bankOffset(pos), sizeof(bankHdr_t));
     return 0;
 }
 
 int cps_readBankData(uint16_t bank_pos, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    if (!cps_valid || bank_pos >= _header()->b_count)
         return -1;
-    if (bank_pos >= header.b_count)
+    if (_buildMaps())
         return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          bank_pos * sizeof(uint32_t),
-          SEEK_CUR);
-    uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    fseek(cps_file, (header.b_count - bank_pos - 1) * sizeof(uint32_t) + offset, SEEK_CUR);
-    bankHdr_t b_header = { 0 };
-    fread(&b_header, sizeof(bankHdr_t), 1, cps_file);
-    if (pos >= b_header.ch_count)
+    size_t b_pos = _bankOffset(bank_pos);
+    if (pos >= _bankChCount(b_pos))
         return -1;
-    fseek(cps_file, pos * sizeof(uint32_t), SEEK_CUR);
-    uint32_t ch_index = 0;
-    fread(&ch_index, sizeof(uint32_t), 1, cps_file);
-    return ch_index;
+    uint32_t id = _read32(b_pos + sizeof(bankHdr_t) + pos * sizeof(uint32_t));
+    if (id >= _records()->ch_slots)
+        return -1;
+    return ch_pos[id];
 }
 
 int cps_writeContact(contact_t contact, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    if (!cps_valid || pos >= _header()->ct_count)
         return -1;
-    if (pos >= header.ct_count)
-        return -1;
-    fseek(cps_file, pos * sizeof(contact_t), SEEK_CUR);
-    fwrite(&contact, sizeof(contact_t), 1, cps_file);
+    uint16_t id = _read16(_ctIndexOffset(pos));
+    _write(_contactOffset(id), &contact, sizeof(contact_t));
     return 0;
 }
 
 int cps_writeChannel(channel_t channel, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.ch_count)
-        return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          pos * sizeof(channel_t),
-          SEEK_CUR);
-    fwrite(&channel, sizeof(channel_t), 1, cps_file);
+    if (!cps_valid || pos >= _header()->ch_count)
+        return -1;
+    // Convert the contact position to its record ID
+    uint16_t ref = _getContactRef(&channel);
+    if (ref < _header()->ct_count)
+        _setContactRef(&channel, _read16(_ctIndexOffset(ref)));
+    else
+        _setContactRef(&channel, CPS_NO_RECORD);
+    uint16_t id = _read16(_chIndexOffset(pos));
+    _write(_channelOffset(id), &channel, sizeof(channel_t));
     return 0;
 }
 
 int cps_writeBankHeader(bankHdr_t b_header, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.b_count)
-        return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          pos * sizeof(uint32_t),
-          SEEK_CUR);
-    uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    fseek(cps_file, header.b_count - pos * sizeof(uint32_t) + offset, SEEK_CUR);
-    fwrite(&b_header, sizeof(bankHdr_t), 1, cps_file);
+    if (!cps_valid || pos >= _header()->b_count)
+        return -1;
+    // Channel count is managed by bank data insertion and deletion
+    size_t b_pos = _bankOffset(pos);
+    b_header.ch_count = _bankChCount(b_pos);
+    _write(b_pos, &b_header, sizeof(bankHdr_t));
     return 0;
 }
 
 int cps_writeBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.b_count + 1)
-        return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          bank_pos * sizeof(uint32_t),
-          SEEK_CUR);
-    uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    fseek(cps_file, (header.b_count - bank_pos - 1) * sizeof(uint32_t) + offset, SEEK_CUR);
-    bankHdr_t b_header = { 0 };
-    fread(&b_header, sizeof(bankHdr_t), 1, cps_file);
-    if (pos >= b_header.ch_count)
-        return -1;
-    fseek(cps_file, pos * sizeof(uint32_t), SEEK_CUR);
-    fwrite(&ch, sizeof(uint32_t), 1, cps_file);
+    if (!cps_valid || bank_pos >= _header()->b_count)
+        return -1;
+    if (ch >= _header()->ch_count)
+        return -1;
+    size_t b_pos = _bankOffset(bank_pos);
+    if (pos >= _bankChCount(b_pos))
+        return -1;
+    uint32_t id = _read16(_chIndexOffset(ch));
+    _write32(b_pos + sizeof(bankHdr_t) + pos * sizeof(uint32_t), id);
     return 0;
 }
 
 int cps_insertContact(contact_t contact, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    if (!cps_valid || pos >= _header()->ct_count + 1)
         return -1;
-    if (pos >= header.ct_count + 1)
+    int id = _allocRecord(false);
+    if (id < 0)
         return -1;
-    long ct_pos = ftell(cps_file) + pos * sizeof(contact_t);
-    _pushDown(ct_pos, sizeof(contact_t));
-    fwrite(&contact, sizeof(contact_t), 1, cps_file);
-    header.ct_count++;
-    _writeHeader(header);
-    if (_updateCtNumbering(pos, true))
+    _write(_contactOffset(id), &contact, sizeof(contact_t));
+    // Add the new record in the contact index
+    size_t i_pos = _ctIndexOffset(pos);
+    if (_pushDown(i_pos, sizeof(uint16_t)))
         return -1;
+    _write16(i_pos, id);
+    cps_header_t header = *_header();
+    header.ct_count++;
+    _writeHeader(&header);
+    maps_valid = false;
     return 0;
 }
 
 int cps_insertChannel(channel_t channel, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
+    if (!cps_valid || pos >= _header()->ch_count + 1)
+        return -1;
+    int id = _allocRecord(true);
+    if (id < 0)
         return -1;
-    if (pos >= header.ch_count + 1)
+    // Add the new record in the channel index
+    size_t i_pos = _chIndexOffset(pos);
+    if (_pushDown(i_pos, sizeof(uint16_t)))
         return -1;
-    long ch_pos = ftell(cps_file) +
-                  header.ct_count * sizeof(contact_t) +
-                  pos * sizeof(channel_t);
-    _pushDown(ch_pos, sizeof(channel_t));
-    fwrite(&channel, sizeof(channel_t), 1, cps_file);
+    _write16(i_pos, id);
+    cps_header_t header = *_header();
     header.ch_count++;
-    _writeHeader(header);
-    _updateChNumbering(pos, true);
-    return 0;
+    _writeHeader(&header);
+    maps_valid = false;
+    return cps_writeChannel(channel, pos);
 }
 
 int cps_insertBankHeader(bankHdr_t b_header, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (pos >= header.b_count + 1)
-        return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          pos * sizeof(uint32_t),
-          SEEK_CUR);
-    long b_offset_pos = ftell(cps_file);
-    uint32_t b_offset = _getBankDataOffset(pos) - _getBankDataOffset(0);
-    // Read position of the new offset
-    _pushDown(b_offset_pos, sizeof(uint32_t));
-    fwrite(&b_offset, sizeof(uint32_t), 1, cps_file);
-    // Update all the offsets following the moved bank
-    for(int i = 0; i < header.b_count - pos; i++)
-    {
-        long p = ftell(cps_file);
-        uint32_t o = 0;
-        fread(&o, sizeof(uint32_t), 1, cps_file);
-        fseek(cps_file, p, SEEK_SET);
-        o += sizeof(bankHdr_t);
-        fwrite(&o, sizeof(uint32_t), 1, cps_file);
-    }
+    if (!cps_valid || pos >= _header()->b_count + 1)
+        return -1;
+    // Offset of the new bank, relative to the beginning of the bank data:
+    // either the one of the bank currently in that position or the end of the
+    // bank data.
+    cps_header_t header = *_header();
+    uint32_t b_offset = _ctIndexOffset(0) - _bankTableOffset(header.b_count);
+    if (pos < header.b_count)
+        b_offset = _read32(_bankTableOffset(pos));
+    // Add the new entry in the offset table
+    size_t t_pos = _bankTableOffset(pos);
+    if (_pushDown(t_pos, sizeof(uint32_t)))
+        return -1;
+    _write32(t_pos, b_offset);
     header.b_count++;
-    _writeHeader(header);
-    _pushDown(_getBankDataOffset(pos), sizeof(bankHdr_t));
-    fwrite(&b_header, sizeof(bankHdr_t), 1, cps_file);
+    _writeHeader(&header);
+    // Banks following the new one are moved down by one bank header
+    _shiftBankOffsets(pos + 1, sizeof(bankHdr_t));
+    size_t b_pos = _bankOffset(pos);
+    if (_pushDown(b_pos, sizeof(bankHdr_t)))
+        return -1;
+    b_header.ch_count = 0;
+    _write(b_pos, &b_header, sizeof(bankHdr_t));
     return 0;
 }
 
 int cps_insertBankData(uint32_t ch, uint16_t bank_pos, uint16_t pos)
 {
-    cps_header_t header = { 0 };
-    if (_readHeader(&header))
-        return -1;
-    if (bank_pos >= header.b_count)
-        return -1;
-    fseek(cps_file,
-          header.ct_count * sizeof(contact_t) +
-          header.ch_count * sizeof(channel_t) +
-          bank_pos * sizeof(uint32_t),
-          SEEK_CUR);
-    uint32_t offset = 0;
-    fread(&offset, sizeof(uint32_t), 1, cps_file);
-    // Update all the offsets following the moved bank
-    for(int i = 0; i < header.b_count - bank_pos - 1; i++)
-    {
-        long p = ftell(cps_file);
-        uint32_t o = 0;
-        fread(&o, sizeof(uint32_t), 1, cps_file);
-        fseek(cps_file, p, SEEK_SET);
-        o += sizeof(uint32_t);
-        fwrite(&o, sizeof(uint32_t), 1, cps_file);
-    }
-    // Update bank header
-    fseek(cps_file, offset, SEEK_CUR);
-    bankHdr_t b_header = { 0 };
-    long h_pos = ftell(cps_file);
-    fread(&b_header, sizeof(bankHdr_t), 1, cps_file);
-    if (pos >= b_header.ch_count + 1)
+    if (!cps_valid || bank_pos >= _header()->b_count)
+        return -1;
+    if (ch >= _header()->ch_count)
+        return -1;
+    size_t b_pos = _bankOffset(bank_pos);
+    if (pos >= _bankChCount(b_pos) + 1)
         return -1;
+    size_t d_pos = b_pos + sizeof(bankHdr_t) + pos * sizeof(uint32_t);
+    if (_pushDown(d_pos, sizeof(uint32_t)))
+        return -1;
+    _write32(d_pos, _read16(_chIndexOffset(ch)));
+    bankHdr_t b_header;
+    memcpy(&b_header, cps_data + b_pos, sizeof(bankHdr_t));
     b_header.ch_count++;
-    fseek(cps_file, h_pos, SEEK_SET);
-    fwrite(&b_header, sizeof(bankHdr_t), 1, cps_file);
-    fseek(cps_file, pos * sizeof(uint32_t), SEEK_CUR);
-    long p = ftell(cps_file);
-    _pushDown(p, sizeof(uint32_t));
-    fwrite(&ch, sizeof(uint32_t), 1, cps_file);
+    _write(b_pos, &b_header, sizeof(bankHdr_t));
+    // Banks following the modified one are moved down by one entry
+    _shiftBankOffsets(bank_pos + 1, sizeof(uint32_t));
+    return 0;
+}
+
+int cps_deleteContact(uint16_t pos)
+{
+    if (!cps_valid || pos >= _header()->ct_count)
+        return -1;
+    size_t   i_pos = _ctIndexOffset(pos);
+    uint16_t id    = _read16(i_pos);
+    _pullUp(i_pos, sizeof(uint16_t));
+    cps_header_t header = *_header();
+    header.ct_count--;
+    _writeHeader(&header);
+    _freeRecord(false, id);
+    // Clear the references to the deleted contact
+    for (int i = 0; i < header.ch_count; i++)
+    {
+        size_t c_pos = _channelOffset(_read16(_chIndexOffset(i)));
+        channel_t *c = (channel_t *) (cps_data + c_pos);
+        if (_getContactRef(c) == id)
+        {
+            _setContactRef(c, CPS_NO_RECORD);
+            _setDirty(c_pos, c_pos + sizeof(channel_t));
+        }
+    }
+    maps_valid = false;
+    return 0;
+}
+
+int cps_deleteChannel(channel_t channel, uint16_t pos)
+{
+    (void) channel;
+
+    if (!cps_valid || pos >= _header()->ch_count)
+        return -1;
+    size_t   i_pos = _chIndexOffset(pos);
+    uint16_t id    = _read16(i_pos);
+    _pullUp(i_pos, sizeof(uint16_t));
+    cps_header_t header = *_header();
+    header.ch_count--;
+    _writeHeader(&header);
+    _freeRecord(true, id);
+    // Remove the deleted channel from the banks
+    for (int i = 0; i < header.b_count; i++)
+    {
+        size_t b_pos = _bankOffset(i);
+        for (int j = _bankChCount(b_pos) - 1; j >= 0; j--)
+        {
+            size_t d_pos = b_pos + sizeof(bankHdr_t) + j * sizeof(uint32_t);
+            if (_read32(d_pos) == id)
+                cps_deleteBankData(i, j);
+        }
+    }
+    maps_valid = false;
+    return 0;
+}
+
+int cps_deleteBankHeader(uint16_t pos)
+{
+    if (!cps_valid || pos >= _header()->b_count)
+        return -1;
+    // Remove the bank data
+    size_t   b_pos  = _bankOffset(pos);
+    uint32_t b_size = sizeof(bankHdr_t) + _bankChCount(b_pos) * sizeof(uint32_t);
+    _pullUp(b_pos, b_size);
+    _shiftBankOffsets(pos + 1, -((int32_t) b_size));
+    // Remove the entry in the offset table
+    _pullUp(_bankTableOffset(pos), sizeof(uint32_t));
+    cps_header_t header = *_header();
+    header.b_count--;
+    _writeHeader(&header);
+    return 0;
+}
+
+int cps_deleteBankData(uint16_t bank_pos, uint16_t pos)
+{
+    if (!cps_valid || bank_pos >= _header()->b_count)
+        return -1;
+    size_t b_pos = _bankOffset(bank_pos);
+    if (pos >= _bankChCount(b_pos))
+        return -1;
+    _pullUp(b_pos + sizeof(bankHdr_t) + pos * sizeof(uint32_t), sizeof(uint32_t));
+    bankHdr_t b_header;
+    memcpy(&b_header, cps_data + b_pos, sizeof(bankHdr_t));
+    b_header.ch_count--;
+    _write(b_pos, &b_header, sizeof(bankHdr_t));
+    // Banks following the modified one are moved up by one entry
+    _shiftBankOffsets(bank_pos + 1, -((int32_t) sizeof(uint32_t)));
     return 0;
 }
@@ -21,6 +21,7 @@
 #include <interfaces/audio.h>
 #include <hwconfig.h>
 #include "file_source.h"
+#include "loopback_linux.h"
 
 
 static const uint8_t pathCompatibilityMatrix[9][9] =
@@ -37,19 +38,55 @@ static const uint8_t pathCompatibilityMatrix[9][9] =
     {    1   ,   1   ,   0   ,   1   ,   1   ,   0   ,   0   ,   0   ,   0   }   // MCU-MCU
 };
 
+/*
+ * When CONFIG_AUDIO_LOOPBACK is defined, the RTX output is fed back to the
+ * RTX input instead of being stored to file.
+ */
+#ifdef CONFIG_AUDIO_LOOPBACK
 const struct audioDevice outputDevices[] =
 {
-    {NULL, 0, 0, SINK_MCU},
-    {NULL, 0, 0, SINK_RTX},
-    {NULL, 0, 0, SINK_SPK},
+    {NULL,                          0,    0, SINK_MCU},
+    {&loopback_output_audio_driver, NULL, 0, SINK_RTX},
+    {NULL,                          0,    0, SINK_SPK},
 };
 
 const struct audioDevice inputDevices[] =
 {
-    {NULL,                      0,                   0, SOURCE_MCU},
-    {&file_source_audio_driver, "/tmp/baseband.raw", 0, SOURCE_RTX},
-    {NULL,                      0,                   0, SOURCE_MIC},
+    {NULL,                         0,    0, SOURCE_MCU},
+    {&loopback_input_audio_driver, NULL, 0, SOURCE_RTX},
+    {NULL,                         0,    0, SOURCE_MIC},
 };
+#else
+/*
+ * Input files can be overridden through the OPENRTX_RTX_SOURCE and
+ * OPENRTX_MIC_SOURCE environment variables, named pipes are supported.
+ */
+static const struct fileSourceCfg rtxSource =
+{
+    "/tmp/baseband.raw",
+    "OPENRTX_RTX_SOURCE"
+};
+
+static const struct fileSourceCfg micSource =
+{
+    "/tmp/mic.raw",
+    "OPENRTX_MIC_SOURCE"
+};
+
+const struct audioDevice outputDevices[] =
+{
+    {NULL,                          0,                     0, SINK_MCU},
+    {&loopback_output_audio_driver, "/tmp/m17_output.raw", 0, SINK_RTX},
+    {NULL,                          0,                     0, SINK_SPK},
+};
+
+const struct audioDevice inputDevices[] =
+{
+    {NULL,                      0,          0, SOURCE_MCU},
+    {&file_source_audio_driver, &rtxSource, 0, SOURCE_RTX},
+    {&file_source_audio_driver, &micSource, 0, SOURCE_MIC},
+};
+#endif
 
 void audio_init()
 {
@@ -19,31 +19,231 @@
  ***************************************************************************/
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
 #include <unistd.h>
-#include <stdio.h>
+#include <fcntl.h>
 #include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <poll.h>
+#include <sys/stat.h>
 #include "file_source.h"
 
-static int fileSource_start(const uint8_t instance, const void *config, struct streamCtx *ctx)
+#define RING_SIZE 16384     // Size of the read-ahead ring buffer, in samples
+
+struct fileSource
+{
+    int              fd;            // Source file descriptor
+    bool             seekable;      // Source is a regular file
+    pthread_t        reader;        // Read-ahead thread
+    pthread_mutex_t  mutex;
+    pthread_cond_t   cond;
+    bool             quit;          // Request termination of the reader
+    bool             eof;           // No more data available from the source
+    size_t           rdPos;         // Ring read position, free running
+    size_t           wrPos;         // Ring write position, free running
+    struct timespec  start;         // Stream start time
+    uint64_t         completed;     // Number of blocks completed
+    stream_sample_t  ring[RING_SIZE];
+};
+
+
+/**
+ * \internal
+ * Read-ahead thread: keeps the ring buffer filled with data from the source
+ * file, rewinding it at the end if it is a regular file.
+ */
+static void *readerFunc(void *arg)
+{
+    struct fileSource *fs = (struct fileSource *) arg;
+    bool   gotData = false;
+    size_t partial = 0;
+
+    while(1)
+    {
+        pthread_mutex_lock(&fs->mutex);
+        while((fs->quit == false) && ((fs->wrPos - fs->rdPos) == RING_SIZE))
+            pthread_cond_wait(&fs->cond, &fs->mutex);
+
+        if(fs->quit)
+        {
+            pthread_mutex_unlock(&fs->mutex);
+            break;
+        }
+
+        // Only the reader writes the free section of the ring: read without
+        // holding the lock, up to the end of the ring.
+        size_t idx  = fs->wrPos % RING_SIZE;
+        size_t free = RING_SIZE - (fs->wrPos - fs->rdPos);
+        if(free > (RING_SIZE - idx))
+            free = RING_SIZE - idx;
+
+        pthread_mutex_unlock(&fs->mutex);
+
+        // Pipes are polled with a timeout, to periodically check for the
+        // termination request while waiting for the writer.
+        if(fs->seekable == false)
+        {
+            struct pollfd pfd = {fs->fd, POLLIN, 0};
+            if(poll(&pfd, 1, 100) <= 0)
+                continue;
+        }
+
+        uint8_t *dest = ((uint8_t *) &fs->ring[idx]) + partial;
+        size_t   len  = (free * sizeof(stream_sample_t)) - partial;
+        ssize_t  ret  = read(fs->fd, dest, len);
+
+        if((ret < 0) && ((errno == EINTR) || (errno == EAGAIN)))
+            continue;
+
+        if((ret == 0) && fs->seekable && gotData)
+        {
+            lseek(fs->fd, 0, SEEK_SET);
+            gotData = false;
+            continue;
+        }
+
+        if(ret <= 0)
+            break;
+
+        // Pipes may return an odd number of bytes
+        size_t bytes = partial + ret;
+        partial = bytes % sizeof(stream_sample_t);
+        gotData = true;
+
+        pthread_mutex_lock(&fs->mutex);
+        fs->wrPos += bytes / sizeof(stream_sample_t);
+        pthread_cond_broadcast(&fs->cond);
+        pthread_mutex_unlock(&fs->mutex);
+    }
+
+    pthread_mutex_lock(&fs->mutex);
+    fs->eof = true;
+    pthread_cond_broadcast(&fs->cond);
+    pthread_mutex_unlock(&fs->mutex);
+
+    return NULL;
+}
+
+/**
+ * \internal
+ * Move a block of samples from the ring buffer to the destination, waiting
+ * for the reader if data is not yet available. Once the source is exhausted
+ * the block is filled with silence.
+ */
+static void fetchSamples(struct fileSource *fs, stream_sample_t *dest,
+                         size_t size)
+{
+    pthread_mutex_lock(&fs->mutex);
+
+    while(size > 0)
+    {
+        while((fs->wrPos == fs->rdPos) && (fs->eof == false))
+            pthread_cond_wait(&fs->cond, &fs->mutex);
+
+        size_t avail = fs->wrPos - fs->rdPos;
+        if(avail == 0)
+        {
+            memset(dest, 0x00, size * sizeof(stream_sample_t));
+            break;
+        }
+
+        size_t idx = fs->rdPos % RING_SIZE;
+        size_t n   = (avail < size) ? avail : size;
+        if(n > (RING_SIZE - idx))
+            n = RING_SIZE - idx;
+
+        memcpy(dest, &fs->ring[idx], n * sizeof(stream_sample_t));
+        fs->rdPos += n;
+        dest      += n;
+        size      -= n;
+    }
+
+    pthread_cond_broadcast(&fs->cond);
+    pthread_mutex_unlock(&fs->mutex);
+}
+
+/**
+ * \internal
+ * Release all the resources of a file source.
+ */
+static void fileSource_close(struct streamCtx *ctx)
+{
+    if(ctx->running == 0)
+        return;
+
+    struct fileSource *fs = (struct fileSource *) ctx->priv;
+
+    pthread_mutex_lock(&fs->mutex);
+    fs->quit = true;
+    pthread_cond_broadcast(&fs->cond);
+    pthread_mutex_unlock(&fs->mutex);
+    pthread_join(fs->reader, NULL);
+
+    close(fs->fd);
+    pthread_mutex_destroy(&fs->mutex);
+    pthread_cond_destroy(&fs->cond);
+    free(fs);
+
+    ctx->running = 0;
+    ctx->priv    = NULL;
+}
+
+static int fileSource_start(const uint8_t instance, const void *config,
+                            struct streamCtx *ctx)
 {
     (void) instance;
 
-    if(ctx == NULL)
+    const struct fileSourceCfg *cfg = (const struct fileSourceCfg *) config;
+
+    if((ctx == NULL) || (cfg == NULL))
         return -EINVAL;
 
     if(ctx->running != 0)
         return -EBUSY;
 
-    ctx->running = 1;
-
-    FILE *fp = fopen(config, "rb");
-    if(fp == NULL)
+    const char *path = cfg->path;
+    if(cfg->envVar != NULL)
     {
-        ctx->running = 0;
+        const char *env = getenv(cfg->envVar);
+        if(env != NULL)
+            path = env;
+    }
+
+    if(path == NULL)
+        return -EINVAL;
+
+    // Non-blocking open, to not wait for the writer when opening a pipe
+    int fd = open(path, O_RDONLY | O_NONBLOCK);
+    if(fd < 0)
         return -EINVAL;
+
+    struct fileSource *fs = malloc(sizeof(struct fileSource));
+    if(fs == NULL)
+    {
+        close(fd);
+        return -ENOMEM;
     }
 
-    ctx->priv = fp;
+    struct stat st;
+    memset(fs, 0x00, offsetof(struct fileSource, ring));
+    fs->fd       = fd;
+    fs->seekable = (fstat(fd, &st) == 0) && S_ISREG(st.st_mode);
+    pthread_mutex_init(&fs->mutex, NULL);
+    pthread_cond_init(&fs->cond, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &fs->start);
+
+    if(pthread_create(&fs->reader, NULL, readerFunc, fs) != 0)
+    {
+        close(fd);
+        free(fs);
+        return -ENOMEM;
+    }
+
+    ctx->priv    = fs;
+    ctx->running = 1;
 
     return 0;
 }
@@ -53,24 +253,22 @@ static int fileSource_data(struct streamCtx *ctx, stream_sample_t **buf)
     if(ctx->running == 0)
         return -1;
 
-    FILE *fp  = (FILE *) ctx->priv;
-    stream_sample_t *dest = *buf;
-    size_t size = ctx->bufSize;
-    size_t i;
+    struct fileSource *fs = (struct fileSource *) ctx->priv;
 
-    if(ctx->bufMode == BUF_CIRC_DOUBLE)
-        size /= 2;
-
-    // Read data from the file, rollover when end is reached
-    while (i < size)
+    if(ctx->bufMode != BUF_CIRC_DOUBLE)
     {
-        size_t n = fread(dest + i, sizeof(stream_sample_t), size - i, fp);
-        if (n < (size - i))
-            fseek(fp, 0, SEEK_SET);
-
-        i += n;
+        *buf = ctx->buffer;
+        return ctx->bufSize;
     }
 
+    // Idle half is the last one completed, as for a DMA transfer the second
+    // half is idle when the stream starts.
+    size_t size = ctx->bufSize / 2;
+    size_t idle = 1;
+    if(fs->completed > 0)
+        idle = (fs->completed - 1) % 2;
+
+    *buf = ctx->buffer + (idle * size);
     return size;
 }
 
@@ -78,34 +276,42 @@ static int fileSource_sync(struct streamCtx *ctx, uint8_t dirty)
 {
     (void) dirty;
 
+    if(ctx->running == 0)
+        return -1;
+
+    struct fileSource *fs = (struct fileSource *) ctx->priv;
     size_t size = ctx->bufSize;
+    stream_sample_t *dest = ctx->buffer;
+
     if(ctx->bufMode == BUF_CIRC_DOUBLE)
+    {
         size /= 2;
+        dest += (fs->completed % 2) * size;
+    }
 
-    // Simulate the time needed to get a new chunck of data from an equivalent
-    // hardware peripheral.
-    uint32_t waitTime = (1000000 * size) / ctx->sampleRate;
-    usleep(waitTime);
-
-    return 0;
-}
+    // Wait for the absolute end time of the current block: being the time
+    // computed from the stream start, a late caller does not accumulate
+    // delays over time.
+    uint64_t samples = (fs->completed + 1) * size;
+    uint64_t nsec    = ((samples % ctx->sampleRate) * 1000000000ULL)
+                     / ctx->sampleRate;
 
-static void fileSource_stop(struct streamCtx *ctx)
-{
-    if(ctx->running == 0)
-        return;
+    struct timespec deadline = fs->start;
+    deadline.tv_sec  += samples / ctx->sampleRate;
+    deadline.tv_nsec += nsec;
+    if(deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec  += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
 
-    FILE *fp = (FILE *) ctx->priv;
-    fclose(fp);
-}
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline,
+                          NULL) == EINTR) ;
 
-static void fileSource_halt(struct streamCtx *ctx)
-{
-    if(ctx->running == 0)
-        return;
+    fetchSamples(fs, dest, size);
+    fs->completed += 1;
 
-    FILE *fp = (FILE *) ctx->priv;
-    fclose(fp);
+    return 0;
 }
 
 #pragma GCC diagnostic ignored "-Wpedantic"
@@ -114,7 +320,7 @@ const struct audioDriver file_source_audio_driver =
     .start     = fileSource_start,
     .data      = fileSource_data,
     .sync      = fileSource_sync,
-    .stop      = fileSource_stop,
-    .terminate = fileSource_halt
+    .stop      = fileSource_close,
+    .terminate = fileSource_close
 };
 #pragma GCC diagnostic pop
@@ -28,11 +28,25 @@ extern "C" {
 #endif
 
 /**
- * Driver providing an audio input stream from a file. File format should be
- * raw, 16 bit, little endian. The configuration parameter is the file name with
- * the full path.
+ * Driver providing an audio input stream from a file or a named pipe. File
+ * format should be raw, 16 bit, little endian. The configuration parameter is
+ * a pointer to a fileSourceCfg structure.
+ *
+ * Data is read ahead by a background thread into a ring buffer, while the
+ * stream buffer is filled at the pace of the requested sample rate, following
+ * the monotonic clock. Regular files are played in loop, pipes provide silence
+ * once closed by the writer.
  */
 
+/**
+ * Configuration of a file audio source.
+ */
+struct fileSourceCfg
+{
+    const char *path;    ///< Default path of the source file.
+    const char *envVar;  ///< Environment variable overriding the path, or NULL.
+};
+
 extern const struct audioDriver file_source_audio_driver;
 
 
@@ -40,4 +54,4 @@ extern const struct audioDriver file_source_audio_driver;
 }
 #endif
 
-#endif /* STM32_DAC_H */
+#endif /* FILE_SOURCE_H */
@@ -0,0 +1,392 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <errno.h>
+#include <math.h>
+#include "loopback_linux.h"
+
+#define FIFO_SIZE   16384    // FIFO size, in samples at output sample rate
+#define MAX_DEV     2400.0f  // Maximum deviation of M17 baseband, in Hz
+
+struct loopbackChannel
+{
+    pthread_mutex_t   mutex;
+    pthread_cond_t    cond;
+    struct streamCtx *out;         // Active output stream
+    struct streamCtx *in;          // Active input stream
+    FILE             *dump;        // Output samples dump file
+    uint32_t          outRate;     // Sample rate of last output stream
+    uint8_t           outIdle;     // Idle half of output buffer
+    uint8_t           inReady;     // Half of input buffer with new data
+    size_t            rdPos;       // FIFO read position
+    size_t            count;       // Number of samples in the FIFO
+    float             power;       // Output signal power estimate
+    float             snr;         // Signal to noise ratio, linear
+    float             offset;      // Frequency offset, fraction of max deviation
+    uint32_t          seed;        // Noise generator state
+    stream_sample_t   fifo[FIFO_SIZE];
+};
+
+static struct loopbackChannel chan =
+{
+    .mutex  = PTHREAD_MUTEX_INITIALIZER,
+    .cond   = PTHREAD_COND_INITIALIZER,
+    .out    = NULL,
+    .in     = NULL,
+    .dump   = NULL,
+    .snr    = INFINITY,
+    .offset = 0.0f,
+    .seed   = 0x12345678
+};
+
+
+/**
+ * \internal
+ * Generate a gaussian random number with zero mean and unit variance using
+ * the Box-Muller transform over a xorshift generator.
+ */
+static float gaussian()
+{
+    float u[2];
+
+    for(int i = 0; i < 2; i++)
+    {
+        chan.seed ^= chan.seed << 13;
+        chan.seed ^= chan.seed >> 17;
+        chan.seed ^= chan.seed << 5;
+        u[i] = ((float) (chan.seed >> 8) + 1.0f) / 16777217.0f;
+    }
+
+    return sqrtf(-2.0f * logf(u[0])) * cosf(2.0f * M_PI * u[1]);
+}
+
+/**
+ * \internal
+ * Push a block of samples from the output stream into the FIFO, blocking if
+ * the FIFO is full. If no input stream is active the samples are discarded.
+ * To be called with the channel mutex locked.
+ */
+static void pushSamples(const stream_sample_t *data, size_t len,
+                        const uint32_t sampleRate)
+{
+    if(chan.dump != NULL)
+        fwrite(data, sizeof(stream_sample_t), len, chan.dump);
+
+    for(size_t i = 0; i < len; i++)
+    {
+        float s = (float) data[i];
+        chan.power += ((s * s) - chan.power) / 4096.0f;
+    }
+
+    while(len > 0)
+    {
+        // Nobody listening, emulate the timing of an hardware peripheral
+        if(chan.in == NULL)
+        {
+            pthread_mutex_unlock(&chan.mutex);
+            usleep((1000000 * len) / sampleRate);
+            pthread_mutex_lock(&chan.mutex);
+            return;
+        }
+
+        size_t space = FIFO_SIZE - chan.count;
+        if(space == 0)
+        {
+            pthread_cond_wait(&chan.cond, &chan.mutex);
+            continue;
+        }
+
+        if(space > len)
+            space = len;
+
+        for(size_t i = 0; i < space; i++)
+        {
+            size_t pos = (chan.rdPos + chan.count) % FIFO_SIZE;
+            chan.fifo[pos] = *data++;
+            chan.count++;
+        }
+
+        len -= space;
+        pthread_cond_broadcast(&chan.cond);
+    }
+}
+
+/**
+ * \internal
+ * Fill a block of the input stream with the samples from the FIFO, blocking
+ * until enough samples are available or the output stream is stopped.
+ * To be called with the channel mutex locked.
+ */
+static void popSamples(stream_sample_t *data, const size_t len,
+                       const uint32_t sampleRate)
+{
+    size_t ratio = 1;
+    if((chan.outRate > sampleRate) && (sampleRate > 0))
+        ratio = chan.outRate / sampleRate;
+
+    while((chan.out != NULL) && (chan.count < (len * ratio)))
+        pthread_cond_wait(&chan.cond, &chan.mutex);
+
+    // Nobody transmitting, emulate the timing of an hardware peripheral
+    if((chan.out == NULL) && (chan.count < (len * ratio)))
+    {
+        pthread_mutex_unlock(&chan.mutex);
+        usleep((1000000 * len) / sampleRate);
+        pthread_mutex_lock(&chan.mutex);
+    }
+
+    float level = sqrtf(chan.power);
+    float dc    = chan.offset * level * 3.0f / sqrtf(5.0f);
+    float sigma = 0.0f;
+    if(isinf(chan.snr) == 0)
+        sigma = level / sqrtf(chan.snr);
+
+    for(size_t i = 0; i < len; i++)
+    {
+        float s = 0.0f;
+        if(chan.count >= ratio)
+        {
+            s = (float) chan.fifo[chan.rdPos];
+            chan.rdPos  = (chan.rdPos + ratio) % FIFO_SIZE;
+            chan.count -= ratio;
+        }
+
+        s += dc + (sigma * gaussian());
+
+        if(s >  32767.0f) s =  32767.0f;
+        if(s < -32768.0f) s = -32768.0f;
+        data[i] = (stream_sample_t) s;
+    }
+
+    pthread_cond_broadcast(&chan.cond);
+}
+
+
+static int loopbackOut_start(const uint8_t instance, const void *config,
+                             struct streamCtx *ctx)
+{
+    (void) instance;
+
+    if(ctx == NULL)
+        return -EINVAL;
+
+    if(ctx->running != 0)
+        return -EBUSY;
+
+    pthread_mutex_lock(&chan.mutex);
+
+    if(chan.out != NULL)
+    {
+        pthread_mutex_unlock(&chan.mutex);
+        return -EBUSY;
+    }
+
+    if(config != NULL)
+        chan.dump = fopen(config, "ab");
+
+    ctx->running = 1;
+    chan.out     = ctx;
+    chan.outRate = ctx->sampleRate;
+    chan.outIdle = 0;
+
+    // Stream starts from the beginning of the buffer, as a DMA transfer would
+    // do. In circular mode the second half becomes the idle one.
+    size_t size = ctx->bufSize;
+    if(ctx->bufMode == BUF_CIRC_DOUBLE)
+    {
+        size /= 2;
+        chan.outIdle = 1;
+    }
+
+    pushSamples(ctx->buffer, size, ctx->sampleRate);
+    pthread_mutex_unlock(&chan.mutex);
+
+    return 0;
+}
+
+static int loopbackOut_data(struct streamCtx *ctx, stream_sample_t **buf)
+{
+    if(ctx->running == 0)
+        return -1;
+
+    if(ctx->bufMode == BUF_CIRC_DOUBLE)
+    {
+        size_t size = ctx->bufSize / 2;
+        *buf = ctx->buffer + (chan.outIdle * size);
+        return size;
+    }
+
+    *buf = ctx->buffer;
+    return ctx->bufSize;
+}
+
+static int loopbackOut_sync(struct streamCtx *ctx, uint8_t dirty)
+{
+    if(ctx->running == 0)
+        return -1;
+
+    if(dirty == 0)
+        return 0;
+
+    stream_sample_t *buf;
+    size_t size = loopbackOut_data(ctx, &buf);
+
+    pthread_mutex_lock(&chan.mutex);
+    pushSamples(buf, size, ctx->sampleRate);
+    if(ctx->bufMode == BUF_CIRC_DOUBLE)
+        chan.outIdle ^= 1;
+    pthread_mutex_unlock(&chan.mutex);
+
+    return 0;
+}
+
+static void loopbackOut_stop(struct streamCtx *ctx)
+{
+    if(ctx->running == 0)
+        return;
+
+    pthread_mutex_lock(&chan.mutex);
+
+    if(chan.dump != NULL)
+    {
+        fclose(chan.dump);
+        chan.dump = NULL;
+    }
+
+    ctx->running = 0;
+    chan.out     = NULL;
+    pthread_cond_broadcast(&chan.cond);
+    pthread_mutex_unlock(&chan.mutex);
+}
+
+static int loopbackIn_start(const uint8_t instance, const void *config,
+                            struct streamCtx *ctx)
+{
+    (void) instance;
+    (void) config;
+
+    if(ctx == NULL)
+        return -EINVAL;
+
+    if(ctx->running != 0)
+        return -EBUSY;
+
+    pthread_mutex_lock(&chan.mutex);
+
+    if(chan.in != NULL)
+    {
+        pthread_mutex_unlock(&chan.mutex);
+        return -EBUSY;
+    }
+
+    ctx->running = 1;
+    chan.in      = ctx;
+    chan.inReady = 1;
+    pthread_mutex_unlock(&chan.mutex);
+
+    return 0;
+}
+
+static int loopbackIn_data(struct streamCtx *ctx, stream_sample_t **buf)
+{
+    if(ctx->running == 0)
+        return -1;
+
+    if(ctx->bufMode == BUF_CIRC_DOUBLE)
+    {
+        size_t size = ctx->bufSize / 2;
+        *buf = ctx->buffer + (chan.inReady * size);
+        return size;
+    }
+
+    *buf = ctx->buffer;
+    return ctx->bufSize;
+}
+
+static int loopbackIn_sync(struct streamCtx *ctx, uint8_t dirty)
+{
+    (void) dirty;
+
+    if(ctx->running == 0)
+        return -1;
+
+    size_t size = ctx->bufSize;
+    if(ctx->bufMode == BUF_CIRC_DOUBLE)
+    {
+        size /= 2;
+        chan.inReady ^= 1;
+    }
+
+    stream_sample_t *buf;
+    loopbackIn_data(ctx, &buf);
+
+    pthread_mutex_lock(&chan.mutex);
+    popSamples(buf, size, ctx->sampleRate);
+    pthread_mutex_unlock(&chan.mutex);
+
+    return 0;
+}
+
+static void loopbackIn_stop(struct streamCtx *ctx)
+{
+    if(ctx->running == 0)
+        return;
+
+    pthread_mutex_lock(&chan.mutex);
+    ctx->running = 0;
+    chan.in      = NULL;
+    chan.rdPos   = 0;
+    chan.count   = 0;
+    pthread_cond_broadcast(&chan.cond);
+    pthread_mutex_unlock(&chan.mutex);
+}
+
+void loopback_setChannel(const float snr, const float freqOffset)
+{
+    pthread_mutex_lock(&chan.mutex);
+    chan.snr    = powf(10.0f, snr / 10.0f);
+    chan.offset = freqOffset / MAX_DEV;
+    pthread_mutex_unlock(&chan.mutex);
+}
+
+#pragma GCC diagnostic ignored "-Wpedantic"
+const struct audioDriver loopback_output_audio_driver =
+{
+    .start     = loopbackOut_start,
+    .data      = loopbackOut_data,
+    .sync      = loopbackOut_sync,
+    .stop      = loopbackOut_stop,
+    .terminate = loopbackOut_stop
+};
+
+const struct audioDriver loopback_input_audio_driver =
+{
+    .start     = loopbackIn_start,
+    .data      = loopbackIn_data,
+    .sync      = loopbackIn_sync,
+    .stop      = loopbackIn_stop,
+    .terminate = loopbackIn_stop
+};
+#pragma GCC diagnostic pop
@@ -0,0 +1,66 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#ifndef LOOPBACK_LINUX_H
+#define LOOPBACK_LINUX_H
+
+#include <interfaces/audio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Drivers providing an in-memory audio loopback channel: the samples written
+ * to the output stream are read back from the input stream, decimated to the
+ * input sample rate. The channel can optionally add white gaussian noise and a
+ * constant offset, emulating a carrier frequency error at the output of an FM
+ * discriminator.
+ *
+ * When there is no active input stream the output samples are discarded, with
+ * the output stream advancing at the same pace of an hardware peripheral.
+ * When there is no active output stream the input stream provides noise only
+ * samples, again at real time pace.
+ *
+ * The configuration parameter of the output driver is the full path of a file
+ * in which all the output samples are also stored, raw 16 bit little endian.
+ * It can be NULL. The input driver has no configuration parameters.
+ */
+
+extern const struct audioDriver loopback_output_audio_driver;
+extern const struct audioDriver loopback_input_audio_driver;
+
+/**
+ * Configure the impairments added by the loopback channel.
+ * Both the noise level and the frequency offset are referred to the measured
+ * power of the output stream, assuming an M17 baseband signal with a maximum
+ * deviation of 2.4kHz.
+ *
+ * @param snr: signal to noise ratio, in dB. Set to INFINITY to disable noise.
+ * @param freqOffset: carrier frequency offset, in Hz.
+ */
+void loopback_setChannel(const float snr, const float freqOffset);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOOPBACK_LINUX_H */
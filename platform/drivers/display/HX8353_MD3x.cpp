@@ -90,11 +90,22 @@
 
 using namespace miosix;
 static Thread *lcdWaiting = 0;
+static volatile bool transferActive = false;
+
+/*
+ * Framebuffer section handed to the DMA by the last render call. Its pixels
+ * are kept in big endian order until the transfer completes and the section
+ * is given back to the caller.
+ */
+static uint16_t *pendingFb    = 0;
+static uint8_t   pendingStart = 0;
+static uint8_t   pendingEnd   = 0;
 
 void __attribute__((used)) DmaImpl()
 {
     DMA2->HIFCR |= DMA_HIFCR_CTCIF7 | DMA_HIFCR_CTEIF7;    /* Clear flags */
     gpio_setPin(LCD_CS);
+    transferActive = false;
 
     if(lcdWaiting == 0) return;
     lcdWaiting->IRQwakeup();
@@ -413,6 +424,9 @@ void display_init()
 
 void display_terminate()
 {
+    /* Let any ongoing transfer complete */
+    display_waitRender();
+
     /* Shut down backlight */
     backlight_terminate();
 
@@ -421,8 +435,28 @@ void display_terminate()
     __DSB();
 }
 
-void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
+/**
+ * \internal
+ * Swap the byte order of the pixels in a section of the framebuffer.
+ */
+static void swapRows(uint16_t *frameBuffer, uint8_t startRow, uint8_t endRow)
 {
+    for(uint8_t y = startRow; y < endRow; y++)
+    {
+        for(uint8_t x = 0; x < CONFIG_SCREEN_WIDTH; x++)
+        {
+            size_t pos = x + y * CONFIG_SCREEN_WIDTH;
+            uint16_t pixel = frameBuffer[pos];
+            frameBuffer[pos] = __builtin_bswap16(pixel);
+        }
+    }
+}
+
+void display_renderRowsAsync(uint8_t startRow, uint8_t endRow, void *fb)
+{
+    /* Only one transfer at a time */
+    display_waitRender();
+
     /*
      * Put screen data lines back to alternate function mode, since they are in
      * common with keyboard buttons and the keyboard driver sets them as inputs.
@@ -436,31 +470,29 @@ void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
     gpio_setMode(LCD_D6, ALTERNATE | ALTERNATE_FUNC(12));
     gpio_setMode(LCD_D7, ALTERNATE | ALTERNATE_FUNC(12));
 
+    transferActive = true;
     gpio_clearPin(LCD_CS);
 
     /*
      * First of all, convert pixels from little to big endian, for
-     * compatibility with the display driver. We do this after having brought
-     * the CS pin low, in this way user code calling the renderingInProgress
-     * function gets true as return value and does not stomp our work.
+     * compatibility with the display driver. We do this after having flagged
+     * the transfer as active, in this way user code calling the
+     * renderingInProgress function gets true as return value and does not
+     * stomp our work.
      */
     uint16_t *frameBuffer = (uint16_t *) fb;
-    for(uint8_t y = startRow; y < endRow; y++)
-    {
-        for(uint8_t x = 0; x < CONFIG_SCREEN_WIDTH; x++)
-        {
-            size_t pos = x + y * CONFIG_SCREEN_WIDTH;
-            uint16_t pixel = frameBuffer[pos];
-            frameBuffer[pos] = __builtin_bswap16(pixel);
-        }
-    }
+    swapRows(frameBuffer, startRow, endRow);
+
+    pendingFb    = frameBuffer;
+    pendingStart = startRow;
+    pendingEnd   = endRow;
 
     /* Configure start and end rows in display driver */
     writeCmd(CMD_RASET);
     writeData(0x00);
     writeData(startRow);
     writeData(0x00);
-    writeData(endRow);
+    writeData(endRow - 1);
 
     /* Now, write to memory */
     writeCmd(CMD_RAMWR);
@@ -481,24 +513,51 @@ void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
                      | DMA_SxCR_TCIE          /* Transfer complete interrupt */
                      | DMA_SxCR_TEIE          /* Transfer error interrupt    */
                      | DMA_SxCR_EN;           /* Start transfer              */
+}
 
+void display_waitRender()
+{
     /*
      * Put the calling thread in waiting status until render completes.
      */
     {
         FastInterruptDisableLock dLock;
-        lcdWaiting = Thread::IRQgetCurrentThread();
-        do
+        if(transferActive)
         {
-            Thread::IRQwait();
+            lcdWaiting = Thread::IRQgetCurrentThread();
+            do
             {
-                FastInterruptEnableLock eLock(dLock);
-                Thread::yield();
-            }
-        } while(lcdWaiting);
+                Thread::IRQwait();
+                {
+                    FastInterruptEnableLock eLock(dLock);
+                    Thread::yield();
+                }
+            } while(lcdWaiting);
+        }
+    }
+
+    /*
+     * Restore the original byte order: rows not redrawn by the caller may be
+     * sent again in a later partial render.
+     */
+    if(pendingFb != 0)
+    {
+        swapRows(pendingFb, pendingStart, pendingEnd);
+        pendingFb = 0;
     }
 }
 
+bool display_renderingInProgress()
+{
+    return transferActive;
+}
+
+void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
+{
+    display_renderRowsAsync(startRow, endRow, fb);
+    display_waitRender();
+}
+
 void display_render(void *fb)
 {
     display_renderRows(0, CONFIG_SCREEN_HEIGHT, fb);
@@ -69,7 +69,7 @@ void SSD1309_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
 
     // Convert rows to pages
     uint8_t startPage = startRow / 8;
-    uint8_t endPage = endRow / 8;
+    uint8_t endPage = (endRow + 7) / 8;
 
     gpio_clearPin(LCD_DC);
     spi2_sendRecv(0x20); // Set page addressing mode
@@ -106,7 +106,11 @@ void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
     spi2_lockDeviceBlocking();
     gpio_clearPin(LCD_CS);
 
-    for(uint8_t row = startRow; row < endRow; row++)
+    // Rows are grouped in pages of eight, round the section to whole pages
+    uint8_t startPage = startRow / 8;
+    uint8_t endPage   = (endRow + 7) / 8;
+
+    for(uint8_t row = startPage; row < endPage; row++)
     {
         gpio_clearPin(LCD_RS);            /* RS low -> command mode */
         (void) spi2_sendRecv(0xB0 | row); /* Set Y position         */
@@ -122,7 +126,7 @@ void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
 
 void display_render(void *fb)
 {
-    display_renderRows(0, CONFIG_SCREEN_HEIGHT / 8, fb);
+    display_renderRows(0, CONFIG_SCREEN_HEIGHT, fb);
 }
 
 void display_setContrast(uint8_t contrast)
@@ -129,6 +129,23 @@ void display_renderRows(uint8_t startRow, uint8_t endRow, void *fb)
     inProgress = false;
 }
 
+void display_renderRowsAsync(uint8_t startRow, uint8_t endRow, void *fb)
+{
+    // Frames are handed over to the SDL main loop, which does the actual
+    // rendering: the copy is short enough to be done synchronously.
+    display_renderRows(startRow, endRow, fb);
+}
+
+void display_waitRender()
+{
+
+}
+
+bool display_renderingInProgress()
+{
+    return inProgress;
+}
+
 void display_render(void *fb)
 {
     display_renderRows(0, CONFIG_SCREEN_HEIGHT, fb);
@@ -0,0 +1,88 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <peripherals/hwcrc.h>
+#include <stm32f4xx.h>
+#include <pthread.h>
+
+/*
+ * The STM32F4 CRC unit computes the CRC-32 with polynomial 0x04C11DB7 over
+ * 32-bit words, without bit reflection and always starting from 0xFFFFFFFF.
+ * The reflected IEEE 802.3 CRC is obtained reversing the bit order of both the
+ * input words and the result, while an arbitrary starting state is loaded by
+ * feeding a word which brings the unit from its reset value to that state.
+ */
+
+static const uint32_t CRC32_POLY = 0x04C11DB7;
+
+static pthread_mutex_t crcMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * \internal
+ * Run the CRC register backwards by 32 bit shifts, that is find the value x
+ * for which feeding a zero word to the CRC unit containing x gives the state
+ * passed as parameter.
+ */
+static uint32_t crc32_unshift(uint32_t state)
+{
+    for(uint8_t i = 0; i < 32; i++)
+    {
+        // The polynomial has its LSB set: the LSB of the state tells whether
+        // it was XORed in during the forward shift.
+        if(state & 0x01)
+            state = ((state ^ CRC32_POLY) >> 1) | 0x80000000;
+        else
+            state >>= 1;
+    }
+
+    return state;
+}
+
+size_t hwcrc_crc32(uint32_t *crc, const void *data, const size_t len)
+{
+    const uint32_t *words = ((const uint32_t *) data);
+    size_t numWords = len / 4;
+
+    if(numWords == 0)
+        return 0;
+
+    if(pthread_mutex_trylock(&crcMutex) != 0)
+        return 0;
+
+    RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
+    __DSB();
+
+    // After reset the data register contains 0xFFFFFFFF, load the current
+    // CRC state.
+    CRC->CR = CRC_CR_RESET;
+    CRC->DR = crc32_unshift(__RBIT(*crc)) ^ 0xFFFFFFFF;
+
+    for(size_t i = 0; i < numWords; i++)
+        CRC->DR = __RBIT(words[i]);
+
+    *crc = __RBIT(CRC->DR);
+
+    RCC->AHB1ENR &= ~RCC_AHB1ENR_CRCEN;
+    __DSB();
+
+    pthread_mutex_unlock(&crcMutex);
+
+    return numWords * 4;
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <M17/M17DSP.hpp>
+#include <iir.hpp>
+#include <fir.hpp>
+#include <dsp.h>
+
+using namespace std;
+
+/**
+ * Compare the fixed-point implementations of the M17 receive path filters
+ * against the floating point ones, using the test baseband as input.
+ */
+
+static constexpr array < float, 3 > sfNum = {4.24433681e-05f, 8.48867363e-05f, 4.24433681e-05f};
+static constexpr array < float, 3 > sfDen = {1.0f,           -1.98148851f,     0.98165828f};
+
+static bool checkError(const char *name, const int32_t maxError,
+                       const int32_t threshold)
+{
+    printf("%s: max error %d\n", name, maxError);
+
+    if(maxError > threshold)
+    {
+        printf("%s: error exceeds threshold (%d)\n", name, threshold);
+        return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    FILE *baseband_file = fopen("../tests/unit/assets/M17_test_baseband.raw", "rb");
+    if(!baseband_file)
+    {
+        perror("Error in reading test baseband");
+        return -1;
+    }
+
+    fseek(baseband_file, 0L, SEEK_END);
+    size_t numSamples = ftell(baseband_file) / sizeof(int16_t);
+    fseek(baseband_file, 0L, SEEK_SET);
+
+    vector< int16_t > baseband(numSamples);
+    if(fread(baseband.data(), sizeof(int16_t), numSamples, baseband_file) != numSamples)
+    {
+        perror("Error in reading test baseband");
+        return -1;
+    }
+
+    fclose(baseband_file);
+
+    // DC removal
+    vector< int16_t > dcrFloat(baseband);
+    vector< int16_t > dcrFixed(baseband);
+    filter_state_t       floatState;
+    filter_state_fixed_t fixedState;
+    dsp_resetFilterState(&floatState);
+    dsp_resetFilterStateFixed(&fixedState);
+    dsp_dcRemoval(&floatState, dcrFloat.data(), numSamples);
+    dsp_dcRemovalFixed(&fixedState, dcrFixed.data(), numSamples);
+
+    int32_t maxError = 0;
+    for(size_t i = 0; i < numSamples; i++)
+        maxError = max(maxError, abs(dcrFloat[i] - dcrFixed[i]));
+
+    if(checkError("DC removal", maxError, 2) == false)
+        return -1;
+
+    // RRC filter, both fed with the same input
+    Fir< M17::rrc_taps_24k.size() >      rrcFloat(M17::rrc_taps_24k);
+    FirFixed< M17::rrc_taps_24k.size() > rrcFixed(M17::rrc_taps_24k);
+    vector< int16_t > rrcOutFloat(numSamples);
+    vector< int16_t > rrcOutFixed(numSamples);
+    rrcFloat.process(dcrFloat.data(), rrcOutFloat.data(), numSamples);
+    rrcFixed.process(dcrFloat.data(), rrcOutFixed.data(), numSamples);
+
+    maxError = 0;
+    for(size_t i = 0; i < numSamples; i++)
+        maxError = max(maxError, abs(rrcOutFloat[i] - rrcOutFixed[i]));
+
+    if(checkError("RRC filter", maxError, 4) == false)
+        return -1;
+
+    // Correlation threshold filter
+    Iir< 3 >      sfFloat(sfNum, sfDen);
+    IirFixed< 3 > sfFixed(sfNum, sfDen);
+
+    maxError = 0;
+    for(size_t i = 0; i < numSamples; i++)
+    {
+        int16_t sample   = rrcOutFloat[i];
+        int32_t thFloat  = static_cast< int32_t >(sfFloat(abs(sample)) + 0.5f);
+        int32_t thFixed  = sfFixed(abs(sample));
+        maxError = max(maxError, abs(thFloat - thFixed));
+    }
+
+    if(checkError("Correlation threshold", maxError, 3) == false)
+        return -1;
+
+    return 0;
+}
@@ -22,6 +22,7 @@
 #include <cstdio>
 #include <cstdint>
 #include <random>
+#include <array>
 #include "M17/M17Golay.hpp"
 
 using namespace std;
@@ -45,6 +46,152 @@ uint32_t generateErrorMask()
     return errorMask;
 }
 
+/**
+ * Convert a codeword to soft bits. Bits flagged in the strong mask are flipped
+ * with full confidence, bits flagged in the weak mask are flipped with low
+ * confidence.
+ */
+array< uint16_t, 24 > toSoftBits(const uint32_t cword, const uint32_t strong,
+                                 const uint32_t weak)
+{
+    array< uint16_t, 24 > bits;
+
+    for(uint8_t i = 0; i < 24; i++)
+    {
+        uint32_t mask = 1 << (23 - i);
+        bool     bit  = (cword & mask) != 0;
+
+        if(strong & mask)
+            bits[i] = bit ? 0x0000 : 0xFFFF;
+        else if(weak & mask)
+            bits[i] = bit ? 0x7800 : 0x8800;
+        else
+            bits[i] = bit ? 0xFFFF : 0x0000;
+    }
+
+    return bits;
+}
+
+/**
+ * Soft-decision decoding has to correct any combination of up to two strong
+ * and some low confidence bit errors for which the transmitted codeword is
+ * still the most likely one, that is when twice the strong errors plus the
+ * weak ones are less than the minimum distance of the code. Up to four weak
+ * errors are tested.
+ */
+bool testSoftDecode()
+{
+    uniform_int_distribution< uint16_t > rndValue(0, 4095);
+    uniform_int_distribution< uint8_t >  numErrs(0, 2);
+    uniform_int_distribution< uint8_t >  errPos(0, 23);
+
+    for(uint32_t i = 0; i < 10000; i++)
+    {
+        uint16_t value  = rndValue(rng);
+        uint32_t cword  = M17::golay24_encode(value);
+        uint32_t strong = 0;
+        uint32_t weak   = 0;
+
+        uint8_t nStrong = numErrs(rng);
+        while(__builtin_popcount(strong) < nStrong)
+            strong |= 1 << errPos(rng);
+
+        uint8_t maxWeak = 7 - (2 * nStrong);
+        if(maxWeak > 4) maxWeak = 4;
+
+        uniform_int_distribution< uint8_t > numWeak(0, maxWeak);
+        uint8_t nWeak = numWeak(rng);
+        while(__builtin_popcount(weak) < nWeak)
+            weak |= (1 << errPos(rng)) & ~strong;
+
+        uint16_t decoded = M17::golay24_softDecode(toSoftBits(cword, strong, weak));
+        if(decoded != value)
+        {
+            printf("Soft value %04x, strong %06x weak %06x -> FAIL\n",
+                   value, strong, weak);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Hard-decision input, with all the bits at full confidence, has to be decoded
+ * as by the algebraic decoder: up to three bit errors are corrected, four are
+ * detected and rejected.
+ */
+bool testHardInput()
+{
+    uniform_int_distribution< uint16_t > rndValue(0, 4095);
+    uniform_int_distribution< uint8_t >  numErrs(0, 4);
+    uniform_int_distribution< uint8_t >  errPos(0, 23);
+
+    for(uint32_t i = 0; i < 10000; i++)
+    {
+        uint16_t value  = rndValue(rng);
+        uint32_t cword  = M17::golay24_encode(value);
+        uint32_t strong = 0;
+
+        uint8_t nErrs = numErrs(rng);
+        while(__builtin_popcount(strong) < nErrs)
+            strong |= 1 << errPos(rng);
+
+        uint16_t decoded  = M17::golay24_softDecode(toSoftBits(cword, strong, 0));
+        uint16_t expected = (nErrs < 4) ? value : 0xFFFF;
+        if(decoded != expected)
+        {
+            printf("Hard value %04x, errors %06x -> %04x, FAIL\n",
+                   value, strong, decoded);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Soft-decision decoding has to reject the codewords with three strong bit
+ * errors when the other bits are not all at full confidence, instead of
+ * returning a wrong or unreliable value.
+ */
+bool testSoftReject()
+{
+    uniform_int_distribution< uint16_t > rndValue(0, 4095);
+    uniform_int_distribution< uint8_t >  errPos(0, 23);
+
+    for(uint32_t i = 0; i < 10000; i++)
+    {
+        uint16_t value  = rndValue(rng);
+        uint32_t cword  = M17::golay24_encode(value);
+        uint32_t strong = 0;
+
+        while(__builtin_popcount(strong) < 3)
+            strong |= 1 << errPos(rng);
+
+        // Lower the confidence of one of the correct bits
+        uint8_t pos;
+        do
+        {
+            pos = errPos(rng);
+        }
+        while(strong & (1 << (23 - pos)));
+
+        auto bits = toSoftBits(cword, strong, 0);
+        bits[pos] = (bits[pos] > 0x7FFF) ? 0xE000 : 0x2000;
+
+        uint16_t decoded = M17::golay24_softDecode(bits);
+        if(decoded != 0xFFFF)
+        {
+            printf("Soft value %04x, strong %06x -> %04x, FAIL\n",
+                   value, strong, decoded);
+            return false;
+        }
+    }
+
+    return true;
+}
+
 int main()
 {
     uniform_int_distribution< uint16_t > rndValue(0, 2047);
@@ -84,5 +231,14 @@ int main()
             return -1;
     }
 
+    if(testSoftDecode() == false)
+        return -1;
+
+    if(testHardInput() == false)
+        return -1;
+
+    if(testSoftReject() == false)
+        return -1;
+
     return 0;
 }
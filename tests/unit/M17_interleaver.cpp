@@ -0,0 +1,196 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <array>
+#include "M17/M17Interleaver.hpp"
+
+using namespace std;
+
+static constexpr size_t NB = 368;
+using frame_t = array< uint8_t, NB / 8 >;
+using soft_t  = array< uint16_t, NB >;
+
+default_random_engine rng;
+
+/**
+ * Reference permutation from the M17 specification, P(x) = 45*x + 92*x^2.
+ */
+static size_t permutation(const size_t i)
+{
+    return ((45 * i) + (92 * i * i)) % NB;
+}
+
+/**
+ * Reference bit by bit interleaver.
+ */
+static frame_t refInterleave(const frame_t& data)
+{
+    frame_t out;
+    out.fill(0x00);
+
+    for(size_t i = 0; i < NB; i++)
+        M17::setBit(out, permutation(i), M17::getBit(data, i));
+
+    return out;
+}
+
+/**
+ * Reference bit by bit deinterleaver.
+ */
+static frame_t refDeinterleave(const frame_t& data)
+{
+    frame_t out;
+    out.fill(0x00);
+
+    for(size_t i = 0; i < NB; i++)
+        M17::setBit(out, i, M17::getBit(data, permutation(i)));
+
+    return out;
+}
+
+/**
+ * Reference soft bit deinterleaver.
+ */
+static soft_t refDeinterleave(const soft_t& data)
+{
+    soft_t out;
+
+    for(size_t i = 0; i < NB; i++)
+        out[i] = data[permutation(i)];
+
+    return out;
+}
+
+/**
+ * The compile-time tables have to match the reference permutation, the inverse
+ * table has to be its inverse and the flip flags have to match the bits of the
+ * decorrelator sequence.
+ */
+bool testTables()
+{
+    constexpr auto& table = M17::InterleaverLut< NB >::table;
+    using entry = M17::InterleaverTable< NB >;
+
+    for(size_t i = 0; i < NB; i++)
+    {
+        size_t index = table.fwd[i] & entry::MASK;
+        bool   flip  = (table.fwd[i] & entry::FLIP) != 0;
+
+        if((index != permutation(i)) || ((table.inv[index] & entry::MASK) != i))
+        {
+            printf("Table entry %zu: fwd %zu, expected %zu, FAIL\n",
+                   i, index, permutation(i));
+            return false;
+        }
+
+        if(flip != M17::getBit(M17::sequence, index))
+        {
+            printf("Table entry %zu: wrong flip flag, FAIL\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Interleaving and deinterleaving, with or without decorrelation, have to give
+ * the same result of the reference bit by bit implementation on random frames.
+ */
+bool testFrames()
+{
+    uniform_int_distribution< uint16_t > rndByte(0, 255);
+    uniform_int_distribution< uint16_t > rndSoft(0, 65535);
+
+    for(uint32_t n = 0; n < 1000; n++)
+    {
+        frame_t frame;
+        soft_t  soft;
+
+        for(auto& byte : frame)
+            byte = rndByte(rng);
+
+        for(auto& bit : soft)
+            bit = rndSoft(rng);
+
+        frame_t expected = refInterleave(frame);
+        frame_t result   = frame;
+        M17::interleave(result);
+        if(result != expected)
+        {
+            printf("Frame %u: interleave FAIL\n", n);
+            return false;
+        }
+
+        M17::decorrelate(expected);
+        result = frame;
+        M17::interleaveAndDecorrelate(result);
+        if(result != expected)
+        {
+            printf("Frame %u: interleaveAndDecorrelate FAIL\n", n);
+            return false;
+        }
+
+        expected = refDeinterleave(frame);
+        result   = frame;
+        M17::deinterleave(result);
+        if(result != expected)
+        {
+            printf("Frame %u: deinterleave FAIL\n", n);
+            return false;
+        }
+
+        soft_t softExpected = refDeinterleave(soft);
+        soft_t softResult   = soft;
+        M17::deinterleave(softResult);
+        if(softResult != softExpected)
+        {
+            printf("Frame %u: soft deinterleave FAIL\n", n);
+            return false;
+        }
+
+        softExpected = soft;
+        M17::decorrelate(softExpected);
+        softExpected = refDeinterleave(softExpected);
+        softResult   = soft;
+        M17::decorrelateAndDeinterleave(softResult);
+        if(softResult != softExpected)
+        {
+            printf("Frame %u: decorrelateAndDeinterleave FAIL\n", n);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    if(testTables() == false)
+        return -1;
+
+    if(testFrames() == false)
+        return -1;
+
+    return 0;
+}
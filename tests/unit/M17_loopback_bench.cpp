@@ -0,0 +1,187 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <M17/M17Modulator.hpp>
+#include <M17/M17Demodulator.hpp>
+#include <loopback_linux.h>
+
+using namespace std;
+using namespace M17;
+
+/**
+ * M17 TX/RX loopback benchmark: a stream of frames is modulated, passed
+ * through the in-memory loopback audio channel and demodulated back, running
+ * both sides as fast as possible.
+ *
+ * Usage: m17_loopback_bench [frames] [SNR dB] [frequency offset Hz]
+ */
+
+static atomic< bool > txDone(false);
+
+/**
+ * Deterministic payload content of a given frame.
+ */
+static payload_t framePayload(const uint16_t frameNum)
+{
+    payload_t payload;
+    for(size_t i = 0; i < payload.size(); i++)
+        payload[i] = static_cast< uint8_t >((frameNum * 31) + (i * 7));
+
+    return payload;
+}
+
+static void transmit(const size_t numFrames)
+{
+    M17Modulator    modulator;
+    M17FrameEncoder encoder;
+    M17LinkSetupFrame lsf;
+    frame_t         frame;
+
+    lsf.clear();
+    lsf.setSource("BENCH");
+
+    streamType_t type;
+    type.value           = 0;
+    type.fields.dataMode = M17_DATAMODE_STREAM;
+    type.fields.dataType = M17_DATATYPE_VOICE;
+    lsf.setType(type);
+    lsf.updateCrc();
+
+    modulator.init();
+    encoder.reset();
+    encoder.encodeLsf(lsf, frame);
+    modulator.start();
+    modulator.send(frame);
+
+    for(size_t i = 0; i < numFrames; i++)
+    {
+        bool last = (i == (numFrames - 1));
+        encoder.encodeStreamFrame(framePayload(i), frame, last);
+        modulator.send(frame);
+    }
+
+    encoder.encodeEotFrame(frame);
+    modulator.send(frame);
+    modulator.stop();
+    modulator.terminate();
+
+    txDone = true;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t numFrames  = 500;
+    float  snr        = INFINITY;
+    float  freqOffset = 0.0f;
+
+    if(argc > 1) numFrames  = strtoul(argv[1], NULL, 10);
+    if(argc > 2) snr        = strtof(argv[2], NULL);
+    if(argc > 3) freqOffset = strtof(argv[3], NULL);
+
+    if(numFrames == 0)
+        return -1;
+
+    loopback_setChannel(snr, freqOffset);
+
+    M17Demodulator  demodulator;
+    M17FrameDecoder decoder;
+    size_t          totalFrames = 0;
+    size_t          goodFrames  = 0;
+    size_t          lsfFrames   = 0;
+    size_t          tailBlocks  = 0;
+
+    demodulator.init();
+    demodulator.startBasebandSampling();
+    decoder.reset();
+
+    auto start = chrono::steady_clock::now();
+    thread tx(transmit, numFrames);
+
+    // Demodulate until the last frame is received. If it gets lost, keep
+    // going for a few blocks after the end of transmission to flush the frames
+    // still in the loopback channel. Each frame is counted once, the ones never
+    // received are errors.
+    vector< bool > received(numFrames, false);
+    bool lastFrame = false;
+    while((lastFrame == false) && (tailBlocks < 32))
+    {
+        if(txDone)
+            tailBlocks++;
+
+        if(demodulator.update(false) == false)
+            continue;
+
+        totalFrames++;
+        auto type = decoder.decodeFrame(demodulator.getSoftFrame());
+
+        if(type == M17FrameType::LINK_SETUP)
+        {
+            if(decoder.getLsf().valid())
+                lsfFrames++;
+        }
+        else if(type == M17FrameType::STREAM)
+        {
+            M17StreamFrame sf  = decoder.getStreamFrame();
+            uint16_t       num = sf.getFrameNumber() & 0x7FFF;
+
+            if((num < numFrames) && (received[num] == false) &&
+               (sf.payload() == framePayload(num)))
+            {
+                received[num] = true;
+                goodFrames++;
+                lastFrame = (num == (numFrames - 1)) && sf.isLastFrame();
+            }
+        }
+    }
+
+    // Stop sampling before joining the transmitter, letting it run to
+    // completion in case the receiver stopped early.
+    auto end = chrono::steady_clock::now();
+    demodulator.stopBasebandSampling();
+    demodulator.terminate();
+    tx.join();
+
+    double elapsed = chrono::duration< double >(end - start).count();
+    double airTime = (numFrames + 4) * 0.040;   // Preamble, LSF and EOT
+    double fer     = 1.0 - (static_cast< double >(goodFrames) / numFrames);
+
+    printf("SNR:                %.1f dB\n", snr);
+    printf("Frequency offset:   %.1f Hz\n", freqOffset);
+    printf("Frames sent:        %zu\n", numFrames);
+    printf("Frames demodulated: %zu (LSF %zu)\n", totalFrames, lsfFrames);
+    printf("Stream frames OK:   %zu\n", goodFrames);
+    printf("Stream frames lost: %zu\n", numFrames - goodFrames);
+    printf("Frame error rate:   %.4f\n", fer);
+    printf("Elapsed time:       %.3f s\n", elapsed);
+    printf("Throughput:         %.1f frames/s\n", numFrames / elapsed);
+    printf("Real-time factor:   %.2fx\n", airTime / elapsed);
+
+    return 0;
+}
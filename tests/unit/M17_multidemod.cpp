@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <complex>
+#include <random>
+#include "M17/M17MultiDemodulator.hpp"
+
+using namespace std;
+
+static constexpr uint32_t SAMPLE_RATE = 200000;   // 8 channels, 25kHz apart
+static constexpr size_t   CHANNELS    = 8;
+static constexpr uint32_t BB_RATE     = 48000;    // Test baseband sample rate
+static constexpr float    FREQ_SCALE  = 3.2f;     // Baseband units per Hz
+static constexpr float    NOISE_RMS   = 0.03f;    // Noise level, per component
+
+/**
+ * Build a wideband capture with the test baseband FM modulated on two
+ * channels plus white noise, about 30dB below the carriers in each channel.
+ * Check that all the occupied channels get decoded and that the demodulators
+ * of the noise-only ones never lock.
+ */
+int main()
+{
+    FILE *fp = fopen("../tests/unit/assets/M17_test_baseband.raw", "rb");
+    if(fp == NULL)
+    {
+        perror("Error in reading test baseband");
+        return -1;
+    }
+
+    vector< int16_t > baseband;
+    int16_t sample;
+    while(fread(&sample, sizeof(int16_t), 1, fp) == 1)
+        baseband.push_back(sample);
+
+    fclose(fp);
+
+    const size_t  occupied[] = {2, 5};
+    const size_t  length     = (baseband.size() - 1) * SAMPLE_RATE / BB_RATE;
+    float         phase[2]   = {0.0f, 0.0f};
+
+    M17::M17MultiDemodulator engine(SAMPLE_RATE, CHANNELS, 4);
+
+    mt19937 rng(1234);
+    normal_distribution< float > noise(0.0f, NOISE_RMS);
+
+    vector< complex< float > > block(10000);
+    size_t n = 0;
+    while(n < length)
+    {
+        size_t count = 0;
+        for(; (count < block.size()) && (n < length); count++, n++)
+        {
+            // Linearly interpolated baseband sample at the capture rate
+            float  pos  = static_cast< float >(n) * BB_RATE / SAMPLE_RATE;
+            size_t idx  = static_cast< size_t >(pos);
+            float  frac = pos - idx;
+            float  bb   = baseband[idx] + (baseband[idx + 1] - baseband[idx]) * frac;
+
+            block[count] = complex< float >(noise(rng), noise(rng));
+            for(size_t c = 0; c < 2; c++)
+            {
+                float freq = engine.channelFrequency(occupied[c])
+                           + (bb / FREQ_SCALE);
+                phase[c]   = fmodf(phase[c] + (2.0f * M_PI * freq / SAMPLE_RATE),
+                                   2.0f * M_PI);
+                block[count] += polar(0.5f, phase[c]);
+            }
+        }
+
+        engine.process(block.data(), count);
+    }
+
+    int ret = 0;
+    for(size_t i = 0; i < CHANNELS; i++)
+    {
+        auto stats = engine.getStats(i);
+        printf("Channel %zu (%+.1f kHz): %u frames, %u LSF (%u valid), %u stream\n",
+               i, engine.channelFrequency(i) / 1000.0f, stats.frames, stats.lsf,
+               stats.validLsf, stats.stream);
+
+        bool used = (i == occupied[0]) || (i == occupied[1]);
+        if(used && ((stats.validLsf != 1) || (stats.stream < 600)))
+            ret = -1;
+
+        if((used == false) && ((stats.lsf != 0) || (stats.stream != 0) ||
+                               (stats.packet != 0)))
+            ret = -1;
+    }
+
+    return ret;
+}
@@ -22,7 +22,9 @@
 #include <limits.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <math.h>
 #include "M17/M17DSP.hpp"
+#include "interpolator.hpp"
 
 #define IMPULSE_SIZE 4096
 
@@ -55,5 +57,59 @@ int main()
     }
     fwrite(filtered_impulse, IMPULSE_SIZE, 1, baseband_out);
     fclose(baseband_out);
+
+    // Block processing of an impulse has to give back the filter taps. The
+    // fixed point filter works on 16-bit samples with the taps quantised to
+    // Q15, allow for the rounding of both.
+    #ifdef CONFIG_M17_FIXED_POINT
+    int16_t block[IMPULSE_SIZE] = { 0 };
+    block[0] = SHRT_MAX;
+    const float scale     = SHRT_MAX;
+    const float tolerance = 2.0f;
+    #else
+    float block[IMPULSE_SIZE] = { 0 };
+    block[0] = 1.0f;
+    const float scale     = 1.0f;
+    const float tolerance = 1e-6;
+    #endif
+    M17::rrc_24k.reset();
+    M17::rrc_24k.process(block, block, IMPULSE_SIZE);
+
+    for(size_t i = 0; i < IMPULSE_SIZE; i++)
+    {
+        float expected = 0.0f;
+        if(i < M17::rrc_taps_24k.size())
+            expected = M17::rrc_taps_24k[i] * scale;
+
+        if(fabs(block[i] - expected) > tolerance)
+        {
+            printf("Block filtering mismatch at sample %zu\n", i);
+            return -1;
+        }
+    }
+
+    // Polyphase interpolation has to match filtering of the zero-stuffed input
+    Interpolator< M17::rrc_taps_48k.size(), 10 > interp(M17::rrc_taps_48k);
+    M17::rrc_48k.reset();
+
+    for(size_t i = 0; i < IMPULSE_SIZE / 10; i++)
+    {
+        float symbol = static_cast< float >((i % 4) * 2) - 3.0f;
+        float interpolated[10];
+        interp(symbol, interpolated);
+
+        for(size_t j = 0; j < 10; j++)
+        {
+            float stuffed  = (j == 0) ? symbol : 0.0f;
+            float expected = M17::rrc_48k(stuffed);
+
+            if(fabs(interpolated[j] - expected) > 1e-5)
+            {
+                printf("Interpolation mismatch at sample %zu\n", (i * 10) + j);
+                return -1;
+            }
+        }
+    }
+
     return 0;
 }
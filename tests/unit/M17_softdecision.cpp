@@ -0,0 +1,153 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <M17/M17FrameEncoder.hpp>
+#include <M17/M17FrameDecoder.hpp>
+#include <M17/M17Modulator.hpp>
+#include <M17/M17Demodulator.hpp>
+#include <loopback_linux.h>
+
+using namespace std;
+using namespace M17;
+
+/**
+ * Soft decision decoding test: a stream of frames is sent through a noisy
+ * loopback channel and each demodulated frame is decoded both from its soft
+ * bits and from its hard symbols. Soft decision decoding has to recover more
+ * frames than the hard decision one.
+ */
+
+static const size_t numFrames = 500;
+static const float  snr       = 10.0f;
+
+static atomic< bool > txDone(false);
+
+static payload_t framePayload(const uint16_t frameNum)
+{
+    payload_t payload;
+    for(size_t i = 0; i < payload.size(); i++)
+        payload[i] = static_cast< uint8_t >((frameNum * 31) + (i * 7));
+
+    return payload;
+}
+
+static void transmit()
+{
+    M17Modulator      modulator;
+    M17FrameEncoder   encoder;
+    M17LinkSetupFrame lsf;
+    frame_t           frame;
+
+    lsf.clear();
+    lsf.setSource("TEST");
+
+    streamType_t type;
+    type.value           = 0;
+    type.fields.dataMode = M17_DATAMODE_STREAM;
+    type.fields.dataType = M17_DATATYPE_VOICE;
+    lsf.setType(type);
+    lsf.updateCrc();
+
+    modulator.init();
+    encoder.reset();
+    encoder.encodeLsf(lsf, frame);
+    modulator.start();
+    modulator.send(frame);
+
+    for(size_t i = 0; i < numFrames; i++)
+    {
+        bool last = (i == (numFrames - 1));
+        encoder.encodeStreamFrame(framePayload(i), frame, last);
+        modulator.send(frame);
+    }
+
+    encoder.encodeEotFrame(frame);
+    modulator.send(frame);
+    modulator.stop();
+    modulator.terminate();
+
+    txDone = true;
+}
+
+static bool frameGood(M17FrameDecoder& decoder, const M17FrameType type)
+{
+    if(type != M17FrameType::STREAM)
+        return false;
+
+    M17StreamFrame sf  = decoder.getStreamFrame();
+    uint16_t       num = sf.getFrameNumber() & 0x7FFF;
+
+    return (num < numFrames) && (sf.payload() == framePayload(num));
+}
+
+int main()
+{
+    loopback_setChannel(snr, 0.0f);
+
+    M17Demodulator  demodulator;
+    M17FrameDecoder softDecoder;
+    M17FrameDecoder hardDecoder;
+    size_t          softFrames = 0;
+    size_t          hardFrames = 0;
+    size_t          tailBlocks = 0;
+
+    demodulator.init();
+    demodulator.startBasebandSampling();
+    softDecoder.reset();
+    hardDecoder.reset();
+
+    thread tx(transmit);
+
+    // Keep demodulating for a few blocks after the end of transmission, to
+    // flush the frames still in the loopback channel.
+    while(tailBlocks < 32)
+    {
+        if(txDone)
+            tailBlocks++;
+
+        if(demodulator.update(false) == false)
+            continue;
+
+        auto softType = softDecoder.decodeFrame(demodulator.getSoftFrame());
+        auto hardType = hardDecoder.decodeFrame(demodulator.getFrame());
+
+        if(frameGood(softDecoder, softType)) softFrames++;
+        if(frameGood(hardDecoder, hardType)) hardFrames++;
+    }
+
+    demodulator.stopBasebandSampling();
+    demodulator.terminate();
+    tx.join();
+
+    printf("SNR %.1f dB, %zu frames: soft decision %zu, hard decision %zu\n",
+           snr, numFrames, softFrames, hardFrames);
+
+    if(softFrames <= hardFrames)
+    {
+        printf("Error: soft decision decoding not better than hard decision\n");
+        return -1;
+    }
+
+    return 0;
+}
@@ -85,5 +85,33 @@ int main()
         }
     }
 
+    // Soft decision decoding, flipped bits are given a low reliability
+    array< uint16_t, 34 * 8 > softBits;
+    array< uint8_t, 34 > clean;
+    M17::puncture(encoded, clean, M17::DATA_PUNCTURE);
+
+    for(size_t i = 0; i < softBits.size(); i++)
+    {
+        bool bit = M17::getBit(punctured, i);
+        if(bit != M17::getBit(clean, i))
+            softBits[i] = bit ? 0x9000 : 0x7000;
+        else
+            softBits[i] = bit ? 0xFFFF : 0x0000;
+    }
+
+    result.fill(0x00);
+    M17::M17SoftViterbi softDecoder;
+    softDecoder.decodePunctured(softBits, result, M17::DATA_PUNCTURE);
+
+    for(size_t i = 0; i < result.size(); i++)
+    {
+        if(source[i] != result[i])
+        {
+            printf("Soft decoding error at pos %ld: got %02x, expected %02x\n",
+                   i, result[i], source[i]);
+            return -1;
+        }
+    }
+
     return 0;
 }
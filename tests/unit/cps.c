@@ -1,4 +1,5 @@
 #include <interfaces/cps_io.h>
+#include <cps_cache.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -118,6 +119,19 @@ int test_createComplexCPS() {
     cps_insertBankData(3, 1, 1);
     cps_insertBankData(4, 1, 2);
     cps_close();
+
+    // Re-open it and read back the banks
+    cps_open("/tmp/test5.rtxc");
+    bankHdr_t b = { 0 };
+    cps_readBankHeader(&b, 1);
+    if(strncmp(b2.name, b.name, 32L) || b.ch_count != 3)
+        return -1;
+    for(int i = 0; i < 3; i++)
+    {
+        if(cps_readBankData(1, i) != i + 2)
+            return -1;
+    }
+    cps_close();
     return 0;
 }
 
@@ -152,6 +166,202 @@ int test_createOOOCPS() {
     return 0;
 }
 
+int test_deleteChannel() {
+    cps_create("/tmp/test7.rtxc");
+
+    cps_open("/tmp/test7.rtxc");
+    channel_t ch1 = { 0, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 1", "", {0}, {{0}} };
+    channel_t ch2 = { 0, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 2", "", {0}, {{0}} };
+    channel_t ch3 = { 0, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 3", "", {0}, {{0}} };
+    bankHdr_t b1 = { "Test Bank 1", 0 };
+    cps_insertChannel(ch1, 0);
+    cps_insertChannel(ch2, 1);
+    cps_insertChannel(ch3, 2);
+    cps_insertBankHeader(b1, 0);
+    cps_insertBankData(0, 0, 0);
+    cps_insertBankData(1, 0, 1);
+    cps_insertBankData(2, 0, 2);
+    cps_deleteChannel(ch2, 1);
+    cps_close();
+
+    // Deleted channel must be removed from the banks
+    cps_open("/tmp/test7.rtxc");
+    channel_t c = { 0 };
+    cps_readChannel(&c, 1);
+    if(strncmp(ch3.name, c.name, 32L))
+        return -1;
+    bankHdr_t b = { 0 };
+    cps_readBankHeader(&b, 0);
+    if(b.ch_count != 2)
+        return -1;
+    if((cps_readBankData(0, 0) != 0) || (cps_readBankData(0, 1) != 1))
+        return -1;
+    cps_close();
+    return 0;
+}
+
+int test_cacheInvalidation() {
+    cps_create("/tmp/test8.rtxc");
+
+    cps_open("/tmp/test8.rtxc");
+    channel_t ch1 = { 0, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 1", "", {0}, {{0}} };
+    channel_t ch2 = { 0, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 2", "", {0}, {{0}} };
+    channel_t c = { 0 };
+    // Reads past the end of the table are cached too
+    if(cpsCache_readChannel(&c, 0) != -1)
+        return -1;
+    cps_insertChannel(ch1, 0);
+    if(cpsCache_readChannel(&c, 0) != 0)
+        return -1;
+    if(strncmp(ch1.name, c.name, 32L))
+        return -1;
+    // Cached entry must be dropped on write
+    cps_writeChannel(ch2, 0);
+    cpsCache_readChannel(&c, 0);
+    if(strncmp(ch2.name, c.name, 32L))
+        return -1;
+    cps_close();
+    return 0;
+}
+
+int test_deleteContact() {
+    cps_create("/tmp/test9.rtxc");
+
+    cps_open("/tmp/test9.rtxc");
+    contact_t ct1 = { "Test contact 1", 0, {{0}} };
+    contact_t ct2 = { "Test contact 2", 0, {{0}} };
+    contact_t ct3 = { "Test contact 3", 0, {{0}} };
+    channel_t ch1 = { OPMODE_M17, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 1", "", {0}, {{0}} };
+    channel_t ch2 = { OPMODE_M17, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 2", "", {0}, {{0}} };
+    cps_insertContact(ct1, 0);
+    cps_insertContact(ct2, 1);
+    cps_insertContact(ct3, 2);
+    ch1.m17.contact_index = 1;
+    ch2.m17.contact_index = 2;
+    cps_insertChannel(ch1, 0);
+    cps_insertChannel(ch2, 1);
+    cps_deleteContact(1);
+    cps_close();
+
+    // References to the deleted contact are dropped, the other ones follow
+    // the new contact positions.
+    cps_open("/tmp/test9.rtxc");
+    contact_t ct = { 0 };
+    cps_readContact(&ct, 1);
+    if(strncmp(ct3.name, ct.name, 32L))
+        return -1;
+    if(cps_readContact(&ct, 2) != -1)
+        return -1;
+    channel_t c = { 0 };
+    cps_readChannel(&c, 0);
+    if(c.m17.contact_index != CPS_NO_RECORD)
+        return -1;
+    cps_readChannel(&c, 1);
+    if(c.m17.contact_index != 1)
+        return -1;
+    // Freed record slot is reused without resurrecting the old reference
+    cps_insertContact(ct2, 0);
+    cps_readChannel(&c, 0);
+    if(c.m17.contact_index != CPS_NO_RECORD)
+        return -1;
+    cps_readChannel(&c, 1);
+    if(c.m17.contact_index != 2)
+        return -1;
+    cps_close();
+    return 0;
+}
+
+int test_migrateCPS() {
+    // Write a v0.1 codeplug: contacts, channels and banks in list order
+    FILE *f = fopen("/tmp/test10.rtxc", "w");
+    if (!f)
+        return -1;
+    cps_header_t header = { 0 };
+    header.magic = CPS_MAGIC;
+    header.version_number = CPS_VERSION_MAJOR << 8 | 1;
+    header.ct_count = 2;
+    header.ch_count = 2;
+    header.b_count = 1;
+    contact_t ct1 = { "Test contact 1", 0, {{0}} };
+    contact_t ct2 = { "Test contact 2", 0, {{0}} };
+    channel_t ch1 = { OPMODE_M17, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 1", "", {0}, {{0}} };
+    channel_t ch2 = { OPMODE_M17, 0, 0, 0, 0, 0, 0, 0, 0, "Test channel 2", "", {0}, {{0}} };
+    ch1.m17.contact_index = 1;
+    ch2.m17.contact_index = 0;
+    uint32_t b_offset = 0;
+    bankHdr_t b1 = { "Test Bank 1", 2 };
+    uint32_t b_data[2] = { 1, 0 };
+    fwrite(&header, sizeof(cps_header_t), 1, f);
+    fwrite(&ct1, sizeof(contact_t), 1, f);
+    fwrite(&ct2, sizeof(contact_t), 1, f);
+    fwrite(&ch1, sizeof(channel_t), 1, f);
+    fwrite(&ch2, sizeof(channel_t), 1, f);
+    fwrite(&b_offset, sizeof(uint32_t), 1, f);
+    fwrite(&b1, sizeof(bankHdr_t), 1, f);
+    fwrite(b_data, sizeof(b_data), 1, f);
+    fclose(f);
+
+    // Read it back twice: right after the migration and once saved
+    for(int i = 0; i < 2; i++)
+    {
+        if(cps_open("/tmp/test10.rtxc"))
+            return -1;
+        contact_t ct = { 0 };
+        cps_readContact(&ct, 1);
+        if(strncmp(ct2.name, ct.name, 32L))
+            return -1;
+        channel_t c = { 0 };
+        cps_readChannel(&c, 0);
+        if(strncmp(ch1.name, c.name, 32L) || c.m17.contact_index != 1)
+            return -1;
+        cps_readChannel(&c, 1);
+        if(strncmp(ch2.name, c.name, 32L) || c.m17.contact_index != 0)
+            return -1;
+        bankHdr_t b = { 0 };
+        cps_readBankHeader(&b, 0);
+        if(strncmp(b1.name, b.name, 32L) || b.ch_count != 2)
+            return -1;
+        if((cps_readBankData(0, 0) != 1) || (cps_readBankData(0, 1) != 0))
+            return -1;
+        cps_close();
+    }
+
+    f = fopen("/tmp/test10.rtxc", "r");
+    if (!f)
+        return -1;
+    fread(&header, sizeof(cps_header_t), 1, f);
+    fclose(f);
+    if(header.version_number != (CPS_VERSION_MAJOR << 8 | CPS_VERSION_MINOR))
+        return -1;
+    return 0;
+}
+
+int test_invalidCPS() {
+    cps_create("/tmp/test11.rtxc");
+
+    // Index tables larger than the whole codeplug must be rejected
+    FILE *f = fopen("/tmp/test11.rtxc", "r+");
+    if (!f)
+        return -1;
+    cps_header_t header = { 0 };
+    cps_records_t rec = { 0 };
+    fread(&header, sizeof(cps_header_t), 1, f);
+    fread(&rec, sizeof(cps_records_t), 1, f);
+    header.ct_count = 1000;
+    rec.ct_slots = 1000;
+    fseek(f, 0L, SEEK_SET);
+    fwrite(&header, sizeof(cps_header_t), 1, f);
+    fwrite(&rec, sizeof(cps_records_t), 1, f);
+    fclose(f);
+
+    cps_open("/tmp/test11.rtxc");
+    contact_t ct = { 0 };
+    if(cps_readContact(&ct, 0) != -1)
+        return -1;
+    cps_close();
+    return 0;
+}
+
 int main() {
     if (test_initCPS())
     {
@@ -183,4 +393,29 @@ int main() {
         printf("Error in creation of Out-Of-Order CPS!\n");
         return -1;
     }
+    if (test_deleteChannel())
+    {
+        printf("Error in channel deletion!\n");
+        return -1;
+    }
+    if (test_cacheInvalidation())
+    {
+        printf("Error in codeplug cache invalidation!\n");
+        return -1;
+    }
+    if (test_deleteContact())
+    {
+        printf("Error in contact deletion!\n");
+        return -1;
+    }
+    if (test_migrateCPS())
+    {
+        printf("Error in codeplug migration!\n");
+        return -1;
+    }
+    if (test_invalidCPS())
+    {
+        printf("Error in invalid codeplug rejection!\n");
+        return -1;
+    }
 }
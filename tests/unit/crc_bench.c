@@ -0,0 +1,212 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <crc.h>
+
+/**
+ * CRC engine benchmark: checks the table-driven CRC implementations against
+ * bitwise reference ones and compares their throughput.
+ *
+ * Usage: crc_bench [buffer size in kB | --check]
+ *
+ * With --check only the correctness checks are run, as done by the unit test.
+ */
+
+#ifdef CONFIG_CRC_SLICE_BY_8
+#define SLICES "slice-by-8"
+#else
+#define SLICES "slice-by-4"
+#endif
+
+typedef uint32_t (*crcFunc_t)(const void *data, const size_t len);
+
+/**
+ * Bitwise CCITT 16-bit CRC, as previously implemented.
+ */
+static uint16_t ref_ccitt(const void *data, const size_t len)
+{
+    uint16_t x   = 0;
+    uint16_t crc = 0;
+    const uint8_t *buf = ((const uint8_t *) data);
+
+    for(size_t i = 0; i < len; i++)
+    {
+        x   = (crc >> 8) ^ buf[i];
+        x  ^= x >> 4;
+        crc = (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
+    }
+
+    return crc;
+}
+
+/**
+ * Bitwise IEEE 802.3 32-bit CRC.
+ */
+static uint32_t ref_crc32(const void *data, const size_t len)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    const uint8_t *buf = ((const uint8_t *) data);
+
+    for(size_t i = 0; i < len; i++)
+    {
+        crc ^= buf[i];
+
+        for(uint8_t j = 0; j < 8; j++)
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+    }
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+static uint32_t wrap_ref_ccitt(const void *data, const size_t len)
+{
+    return ref_ccitt(data, len);
+}
+
+static uint32_t wrap_crc_ccitt(const void *data, const size_t len)
+{
+    return crc_ccitt(data, len);
+}
+
+static double timeNow()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+static void bench(const char *name, crcFunc_t func, const uint8_t *buf,
+                  const size_t len)
+{
+    volatile uint32_t result = 0;
+    size_t rounds  = 0;
+    double start   = timeNow();
+    double elapsed;
+
+    do
+    {
+        result = func(buf, len);
+        rounds++;
+        elapsed = timeNow() - start;
+    }
+    while(elapsed < 0.25);
+
+    double mbps = ((double) rounds * len) / (elapsed * 1024.0 * 1024.0);
+    printf("%-24s %9.1f MB/s (CRC %08x)\n", name, mbps, result);
+}
+
+/**
+ * Check the one-shot and streaming interfaces against the reference
+ * implementations, splitting the data in random sized chunks.
+ */
+static int checkCrc(const uint8_t *buf, const size_t len)
+{
+    const char *check = "123456789";
+
+    if(crc_ccitt(check, 9) != 0x31C3)
+        return -1;
+
+    if(crc_32(check, 9) != 0xCBF43926)
+        return -1;
+
+    for(size_t i = 0; i < 1000; i++)
+    {
+        size_t   size   = rand() % len;
+        size_t   offset = rand() % (len - size);
+        uint16_t c16    = crc_ccitt_init();
+        uint32_t c32    = crc_32_init();
+        size_t   pos    = 0;
+
+        while(pos < size)
+        {
+            size_t chunk = rand() % 300;
+            if(chunk > (size - pos))
+                chunk = size - pos;
+
+            c16  = crc_ccitt_update(c16, buf + offset + pos, chunk);
+            c32  = crc_32_update(c32, buf + offset + pos, chunk);
+            pos += chunk;
+        }
+
+        if(crc_ccitt_final(c16) != ref_ccitt(buf + offset, size))
+            return -1;
+
+        if(crc_32_final(c32) != ref_crc32(buf + offset, size))
+            return -1;
+
+        if(crc_32(buf + offset, size) != ref_crc32(buf + offset, size))
+            return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t len       = 64 * 1024;
+    bool   checkOnly = false;
+
+    if(argc > 1)
+    {
+        if(strcmp(argv[1], "--check") == 0)
+            checkOnly = true;
+        else
+            len = atoi(argv[1]) * 1024;
+    }
+
+    if(len < 1024)
+        len = 1024;
+
+    uint8_t *buf = ((uint8_t *) malloc(len));
+    if(buf == NULL)
+        return -1;
+
+    srand(1234);
+    for(size_t i = 0; i < len; i++)
+        buf[i] = rand();
+
+    if(checkCrc(buf, len) < 0)
+    {
+        printf("CRC mismatch against reference implementation!\n");
+        free(buf);
+        return -1;
+    }
+
+    if(checkOnly)
+    {
+        free(buf);
+        return 0;
+    }
+
+    printf("Buffer size: %zu kB, tables: %s\n", len / 1024, SLICES);
+    bench("CRC-16/CCITT bitwise",  wrap_ref_ccitt, buf, len);
+    bench("CRC-16/CCITT " SLICES,  wrap_crc_ccitt, buf, len);
+    bench("CRC-32 bitwise",        ref_crc32,      buf, len);
+    bench("CRC-32 " SLICES,        crc_32,         buf, len);
+
+    free(buf);
+    return 0;
+}
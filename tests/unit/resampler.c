@@ -0,0 +1,130 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <resampler.h>
+
+/**
+ * Sample rate converter test: for every conversion ratio allowed, check the
+ * number of output samples generated and that a constant input is converted
+ * with unity gain. Ratios beyond the maximum factor have to be rejected.
+ */
+
+#define IN_LEN   800
+#define DC_LEVEL 10000
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while(b != 0)
+    {
+        uint32_t t = b;
+        b = a % b;
+        a = t;
+    }
+
+    return a;
+}
+
+static int testRatio(const uint32_t up, const uint32_t down)
+{
+    static stream_sample_t in[IN_LEN];
+    static stream_sample_t out[IN_LEN * RESAMPLER_MAX_FACTOR];
+    struct resampler rs;
+
+    if(resampler_init(&rs, down * 8000, up * 8000) != 0)
+    {
+        printf("%u/%u: initialisation failed\n", up, down);
+        return -1;
+    }
+
+    for(size_t i = 0; i < IN_LEN; i++)
+        in[i] = DC_LEVEL;
+
+    // Convert in blocks of different sizes
+    size_t outLen = 0;
+    size_t pos    = 0;
+    size_t block  = 1;
+    while(pos < IN_LEN)
+    {
+        if(block > (IN_LEN - pos))
+            block = IN_LEN - pos;
+
+        outLen += resampler_process(&rs, &in[pos], block, &out[outLen]);
+        pos    += block;
+        block   = (block * 3) % 97 + 1;
+    }
+
+    size_t expected = ((IN_LEN * up) + down - 1) / down;
+    if(outLen != expected)
+    {
+        printf("%u/%u: %zu output samples, expected %zu\n", up, down, outLen,
+               expected);
+        return -1;
+    }
+
+    // Skip the filter transient, then all the branches have to give the same
+    // output level.
+    for(size_t i = outLen / 2; i < outLen; i++)
+    {
+        if(abs(out[i] - DC_LEVEL) > (DC_LEVEL / 100))
+        {
+            printf("%u/%u: sample %zu is %d, expected %d\n", up, down, i,
+                   out[i], DC_LEVEL);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int main()
+{
+    struct resampler rs;
+
+    for(uint32_t up = 1; up <= RESAMPLER_MAX_FACTOR; up++)
+    {
+        for(uint32_t down = 1; down <= RESAMPLER_MAX_FACTOR; down++)
+        {
+            if(gcd(up, down) != 1)
+                continue;
+
+            if(testRatio(up, down) < 0)
+                return -1;
+        }
+    }
+
+    if(resampler_init(&rs, 8000, 9000) == 0)
+    {
+        printf("9/8: ratio not rejected\n");
+        return -1;
+    }
+
+    if(resampler_init(&rs, 44100, 48000) == 0)
+    {
+        printf("160/147: ratio not rejected\n");
+        return -1;
+    }
+
+    printf("PASS\n");
+
+    return 0;
+}
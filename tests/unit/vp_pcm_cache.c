@@ -0,0 +1,159 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by Federico Amedeo Izzo IU2NUO,                    *
+ *                         Niccolò Izzo IU2KIN                             *
+ *                         Frederik Saraci IU2NRO                          *
+ *                         Silvano Seva IU2KWO                             *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, see <http://www.gnu.org/licenses/>   *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <vp_pcm_cache.h>
+
+/**
+ * Voice prompt PCM cache test: prompts are cached only after being filled,
+ * only one entry at a time is reserved and the entry of the least used prompt
+ * is replaced by a more used one.
+ */
+
+#if VP_PCM_CACHE_ENTRIES < 2
+#error "The PCM cache test requires VP_PCM_CACHE_ENTRIES >= 2"
+#endif
+
+#define FRAMES 10
+
+/**
+ * Use a prompt until it gets cached, filling its entry when reserved.
+ */
+static int cachePrompt(const uint16_t prompt)
+{
+    for(int i = 0; i < 100; i++)
+    {
+        if(vpPcmCache_get(prompt, FRAMES) != NULL)
+            return 0;
+
+        vpPcmEntry_t *entry = vpPcmCache_reserved();
+        if((entry != NULL) && (entry->prompt == prompt))
+            vpPcmCache_endFill(FRAMES);
+    }
+
+    return -1;
+}
+
+static int testMiss()
+{
+    vpPcmCache_reset();
+
+    // First use: miss, an empty entry is reserved for the prompt
+    if(vpPcmCache_get(1, FRAMES) != NULL)
+        return -1;
+
+    vpPcmEntry_t *entry = vpPcmCache_reserved();
+    if((entry == NULL) || (entry->prompt != 1))
+        return -1;
+
+    // Only one entry at a time is reserved
+    if((vpPcmCache_get(2, FRAMES) != NULL) || (vpPcmCache_reserved() != entry))
+        return -1;
+
+    // Partial fill: the entry stays empty
+    vpPcmCache_endFill(FRAMES - 1);
+    if((vpPcmCache_reserved() != NULL) || (vpPcmCache_find(1) != NULL))
+        return -1;
+
+    // Prompts longer than an entry are never cached
+    vpPcmCache_get(3, (VP_PCM_CACHE_SAMPLES / 160) + 1);
+    vpPcmEntry_t *res = vpPcmCache_reserved();
+    if((res != NULL) && (res->prompt == 3))
+        return -1;
+
+    vpPcmCache_endFill(0);
+    return 0;
+}
+
+static int testHit()
+{
+    vpPcmCache_reset();
+
+    vpPcmCache_get(1, FRAMES);
+    vpPcmCache_endFill(FRAMES);
+
+    vpPcmEntry_t *entry = vpPcmCache_find(1);
+    if((entry == NULL) || (entry->length != FRAMES * 160))
+        return -1;
+
+    if(vpPcmCache_get(1, FRAMES) != entry)
+        return -1;
+
+    return 0;
+}
+
+static int testEviction()
+{
+    vpPcmCache_reset();
+
+    // Fill the cache, prompt n being used n + 1 times
+    for(uint16_t p = 0; p < VP_PCM_CACHE_ENTRIES; p++)
+    {
+        for(uint16_t i = 0; i < p; i++)
+            vpPcmCache_get(p, FRAMES);
+
+        if(cachePrompt(p) < 0)
+            return -1;
+    }
+
+    // A prompt used less than all the cached ones does not get an entry
+    const uint16_t newPrompt = VP_PCM_CACHE_ENTRIES;
+    vpPcmCache_get(newPrompt, FRAMES);
+    if(vpPcmCache_reserved() != NULL)
+        return -1;
+
+    // Once used more than the least used one, it replaces it
+    if(cachePrompt(newPrompt) < 0)
+        return -1;
+
+    if(vpPcmCache_find(0) != NULL)
+        return -1;
+
+    for(uint16_t p = 1; p <= VP_PCM_CACHE_ENTRIES; p++)
+    {
+        if(vpPcmCache_find(p) == NULL)
+            return -1;
+    }
+
+    return 0;
+}
+
+int main()
+{
+    if(testMiss() < 0)
+    {
+        printf("Error in PCM cache miss!\n");
+        return -1;
+    }
+
+    if(testHit() < 0)
+    {
+        printf("Error in PCM cache hit!\n");
+        return -1;
+    }
+
+    if(testEviction() < 0)
+    {
+        printf("Error in PCM cache eviction!\n");
+        return -1;
+    }
+
+    return 0;
+}